@@ -0,0 +1,98 @@
+#include "AVLMap.hpp"
+#include "ConcurrentAVLMap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 对照组：一把全局互斥锁保护的 AVLMap
+class LockedMap {
+public:
+    LockedMap() : mutex_(), map_() {}
+
+    bool get(int key, int &out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (const int *p = map_.get(key)) {
+            out = *p;
+            return true;
+        }
+        return false;
+    }
+
+    void put(int key, int value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        map_.put(key, value);
+    }
+
+    bool remove(int key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool found = map_.get(key) != nullptr;
+        map_.remove(key);
+        return found;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    AVLMap<int, int>   map_;
+};
+
+// threads 个线程共执行 total 次操作，其中 write_pct% 为写（插入和删除各半）
+template<typename Map>
+void run(const char *name, size_t threads, size_t total, unsigned write_pct) {
+    const size_t ops  = total / threads;
+    const int    keys = 100000;
+    Map          map;
+    for (int k = 0; k < keys; k += 2) map.put(k, k);
+
+    std::vector<std::thread> pool;
+    std::vector<long long>   sums(threads, 0);
+    auto                     start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&map, &sums, ops, write_pct, t] {
+            std::mt19937 rng(static_cast<unsigned>(t + 1));
+            long long    sum = 0;
+            for (size_t i = 0; i < ops; ++i) {
+                int      key  = static_cast<int>(rng() % keys);
+                auto     dice = rng() % 200;
+                int      v    = 0;
+                if (dice < write_pct) {
+                    map.put(key, key);
+                } else if (dice < 2 * write_pct) {
+                    map.remove(key);
+                } else if (map.get(key, v)) {
+                    sum += v;
+                }
+            }
+            sums[t] = sum;
+        });
+    }
+    for (auto &th : pool) th.join();
+    auto      stop = std::chrono::steady_clock::now();
+    double    sec  = std::chrono::duration<double>(stop - start).count();
+    long long sink = 0;
+    for (long long s : sums) sink += s;
+    std::printf(
+        "  %-10s %2zu threads %8.2f Mops/s (sink %lld)\n", name, threads,
+        double(ops * threads) / sec / 1e6, sink);
+}
+
+}   // namespace
+
+int main() {
+    const size_t total = 4000000;
+    const size_t max_threads =
+        std::max<size_t>(32, std::thread::hardware_concurrency());
+    for (unsigned write_pct : {5u, 0u}) {
+        std::printf("%u%% writes, %zu ops\n", write_pct, total);
+        for (size_t t = 1; t <= max_threads; t *= 2) {
+            run<ConcurrentAVLMap<int, int>>("concurrent", t, total, write_pct);
+            run<LockedMap>("mutex", t, total, write_pct);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "LockFreeStack.hpp"
+#include "MyStack.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 对照组：互斥锁保护的 MyStack
+class LockedStack {
+public:
+    LockedStack() : mutex_(), stack_() {}
+
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stack_.push(value);
+    }
+
+    bool try_pop(int &out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stack_.empty()) {
+            return false;
+        }
+        out = stack_.top();
+        stack_.pop();
+        return true;
+    }
+
+private:
+    std::mutex   mutex_;
+    MyStack<int> stack_;
+};
+
+// 每个线程反复压入一个值再弹出一个，模拟共享空闲列表
+template<typename Stack>
+void run(const char *name, size_t threads, size_t per_thread) {
+    Stack st;
+    for (int i = 0; i < 64; ++i) st.push(i);
+    std::vector<std::thread> pool;
+    std::vector<long long>   sums(threads, 0);
+    auto                     start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&st, &sums, per_thread, t] {
+            int v = 0;
+            for (size_t i = 0; i < per_thread; ++i) {
+                st.push(static_cast<int>(i));
+                if (st.try_pop(v)) sums[t] += v;
+            }
+        });
+    }
+    for (auto &th : pool) th.join();
+    auto   stop = std::chrono::steady_clock::now();
+    double sec  = std::chrono::duration<double>(stop - start).count();
+    long long sink = 0;
+    for (long long s : sums) sink += s;
+    std::printf(
+        "  %-12s %2zu threads %8.2f Mops/s (sink %lld)\n", name, threads,
+        double(2 * per_thread * threads) / sec / 1e6, sink);
+}
+
+}   // namespace
+
+int main() {
+    const size_t per_thread = 1000000;
+    const size_t max_threads =
+        std::max<size_t>(2, std::thread::hardware_concurrency());
+    std::printf("push + pop pairs, %zu per thread\n", per_thread);
+    for (size_t t = 1; t <= max_threads; t *= 2) {
+        run<LockedStack>("mutex", t, per_thread);
+        run<LockFreeStack<int>>("treiber", t, per_thread);
+        run<LockFreeStack<int, true>>("elimination", t, per_thread);
+    }
+    return 0;
+}
@@ -0,0 +1,295 @@
+#include "AVLMap.hpp"
+#include "AVLSetOps.hpp"
+#include "BSTMap.hpp"
+#include "BTree.hpp"
+#include "CompactAVLMap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+template<typename Fn> void run(const char *name, size_t ops, Fn &&fn) {
+    auto      start = std::chrono::steady_clock::now();
+    long long sink  = fn();
+    auto      stop  = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    std::printf(
+        "  %-12s %8.2f ns/op (sink %lld)\n", name, ns / double(ops), sink);
+}
+
+// 按给定顺序插入，再按同样顺序查找一遍
+long long map_insert_find(const std::vector<int> &keys, size_t &height) {
+    Map<int, int> m;
+    for (int k : keys) m.insert(k, k);
+    long long sum = 0;
+    for (int k : keys) sum += m.find(k)->data.second;
+    height = m.height();
+    return sum;
+}
+
+long long std_insert_find(const std::vector<int> &keys) {
+    std::map<int, int> m;
+    for (int k : keys) m.emplace(k, k);
+    long long sum = 0;
+    for (int k : keys) sum += m.find(k)->second;
+    return sum;
+}
+
+void compare(const char *order, const std::vector<int> &keys) {
+    size_t height = 0;
+    std::printf("%s, %zu keys\n", order, keys.size());
+    run("Map", keys.size(), [&] { return map_insert_find(keys, height); });
+    run("std::map", keys.size(), [&] { return std_insert_find(keys); });
+    std::printf("  Map height %zu\n", height);
+}
+
+// 模拟每个请求建一棵小树再丢弃
+template<typename Tree> long long build_and_clear(size_t trees, size_t size) {
+    Tree      tree;
+    long long sum = 0;
+    for (size_t t = 0; t < trees; ++t) {
+        for (size_t i = 0; i < size; ++i) {
+            int k = static_cast<int>((i * 7919) % size);
+            if constexpr (std::is_same_v<Tree, Map<int, int, HeapNodes>>
+                          || std::is_same_v<Tree, Map<int, int>>) {
+                tree.insert(k, k);
+            } else {
+                tree.put(k, k);
+            }
+        }
+        sum += static_cast<long long>(t);
+        tree.clear();
+    }
+    return sum;
+}
+
+// 已排序的数据重新载入：逐个插入对比一次性建树
+void reload(const std::vector<std::pair<int, int>> &items) {
+    const size_t n = items.size();
+    std::printf("reload %zu sorted pairs\n", n);
+    run("Map insert", n, [&] {
+        Map<int, int> m;
+        for (const auto &kv : items) m.insert(kv.first, kv.second);
+        return static_cast<long long>(m.height());
+    });
+    run("Map bulk", n, [&] {
+        Map<int, int> m(items.begin(), items.end());
+        return static_cast<long long>(m.height());
+    });
+    run("AVL put", n, [&] {
+        AVLMap<int, int> m;
+        for (const auto &kv : items) m.put(kv.first, kv.second);
+        return static_cast<long long>(*m.get(0));
+    });
+    run("AVL bulk", n, [&] {
+        AVLMap<int, int> m(items.begin(), items.end());
+        return static_cast<long long>(*m.get(0));
+    });
+    std::vector<std::pair<int, int>> shuffled(items);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(7));
+    run("Map unsorted", n, [&] {
+        Map<int, int> m(shuffled.begin(), shuffled.end());
+        return static_cast<long long>(m.height());
+    });
+}
+
+// AVLMap 的插入、查找、删除，keys 决定访问顺序
+void avl_ops(const std::vector<int> &keys) {
+    const size_t     n = keys.size();
+    AVLMap<int, int> m;
+    std::printf("AVLMap, %zu random keys\n", n);
+    run("put", n, [&] {
+        for (int k : keys) m.put(k, k);
+        return static_cast<long long>(m.size());
+    });
+    run("get", n, [&] {
+        long long sum = 0;
+        for (int k : keys) sum += *m.get(k);
+        return sum;
+    });
+    run("get miss", n, [&] {
+        long long hits = 0;
+        for (int k : keys) hits += m.get(-k - 1) != nullptr;
+        return hits;
+    });
+    run("remove", n, [&] {
+        for (int k : keys) m.remove(k);
+        return static_cast<long long>(m.size());
+    });
+}
+
+template<typename Tree> void lookup(const char *name, const Tree &t,
+                                    const std::vector<int> &keys) {
+    run(name, keys.size(), [&] {
+        long long sum = 0;
+        for (int k : keys) sum += *t.get(k);
+        return sum;
+    });
+}
+
+// B+ 树对比 AVLMap：随机插入、查找，以及按顺序扫描全部元素
+void btree_ops(const std::vector<int> &keys) {
+    const size_t     n = keys.size();
+    BTree<int, int>  tree;
+    AVLMap<int, int> avl;
+    std::printf("BTree vs AVLMap, %zu random keys\n", n);
+    run("BTree insert", n, [&] {
+        for (int k : keys) tree.insert(k, k);
+        return static_cast<long long>(tree.size());
+    });
+    run("AVL put", n, [&] {
+        for (int k : keys) avl.put(k, k);
+        return static_cast<long long>(avl.size());
+    });
+    run("BTree search", n, [&] {
+        long long sum = 0;
+        for (int k : keys) sum += *tree.search(k);
+        return sum;
+    });
+    run("AVL get", n, [&] {
+        long long sum = 0;
+        for (int k : keys) sum += *avl.get(k);
+        return sum;
+    });
+    run("BTree scan", n, [&] {
+        long long sum = 0;
+        for (auto it = tree.begin(); it != tree.end(); ++it) sum += it.value();
+        return sum;
+    });
+    run("AVL scan", n, [&] {
+        long long sum = 0;
+        for (auto it = avl.begin(); it != avl.end(); ++it) sum += it->value;
+        return sum;
+    });
+    run("BTree erase", n, [&] {
+        for (int k : keys) tree.erase(k);
+        return static_cast<long long>(tree.size());
+    });
+}
+
+// 同一组键在不同节点布局下的节点大小、每个元素占用的内存和随机查找速度。
+// AVLMap 的节点来自内存块，每个元素正好占一个节点
+void layouts(const std::vector<int> &keys) {
+    const size_t     n = keys.size();
+    std::vector<int> probe(keys);
+    std::shuffle(probe.begin(), probe.end(), std::mt19937(5));
+
+    AVLMap<int, int>               arena;
+    CompactAVLMap<int, int>        split;
+    CompactAVLMap<int, int, false> inline_values;
+    for (int k : keys) {
+        arena.put(k, k);
+        split.put(k, k);
+        inline_values.put(k, k);
+    }
+    std::printf("node layout, %zu random keys\n", n);
+    std::printf("  %-12s %8zu B/node %8.2f B/entry\n", "AVLMap",
+                sizeof(AVLNode<int, int>), double(sizeof(AVLNode<int, int>)));
+    std::printf("  %-12s %8zu B/node %8.2f B/entry\n", "compact",
+                CompactAVLMap<int, int>::node_bytes,
+                double(split.memory_usage()) / double(n));
+    std::printf("  %-12s %8zu B/node %8.2f B/entry\n", "inline",
+                CompactAVLMap<int, int, false>::node_bytes,
+                double(inline_values.memory_usage()) / double(n));
+    lookup("AVLMap get", arena, probe);
+    lookup("compact get", split, probe);
+    lookup("inline get", inline_values, probe);
+}
+
+// 集合运算：逐个 get / put 对比基于 split / join 的批量运算。
+// a 有 n 个偶数键，b 有 m 个键，其中一半与 a 重叠
+void set_ops(size_t n, size_t m) {
+    std::vector<std::pair<int, int>> a(n), b(m);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = {static_cast<int>(2 * i), 1};
+    }
+    const size_t stride = std::max<size_t>(1, n / m);
+    for (size_t i = 0; i < m; ++i) {
+        b[i] = {static_cast<int>(2 * i * stride + i % 2), 2};
+    }
+    std::sort(b.begin(), b.end());
+    AVLMap<int, int> other(b.begin(), b.end());
+    const size_t     ops = n + m;
+    std::printf("set ops, %zu x %zu keys\n", n, m);
+    run("union loop", ops, [&] {
+        AVLMap<int, int> t(a.begin(), a.end());
+        for (const auto &kv : other) t.put(kv.key, kv.value);
+        return static_cast<long long>(t.size());
+    });
+    run("union join", ops, [&] {
+        AVLMap<int, int> t(a.begin(), a.end());
+        avl_set::union_with(t, other);
+        return static_cast<long long>(t.size());
+    });
+    run("inter loop", ops, [&] {
+        AVLMap<int, int> t(a.begin(), a.end()), res;
+        for (const auto &kv : other) {
+            if (const int *v = t.get(kv.key)) res.put(kv.key, *v);
+        }
+        return static_cast<long long>(res.size());
+    });
+    run("inter join", ops, [&] {
+        AVLMap<int, int> t(a.begin(), a.end());
+        avl_set::intersect_with(t, other);
+        return static_cast<long long>(t.size());
+    });
+    run("diff loop", ops, [&] {
+        AVLMap<int, int> t(a.begin(), a.end());
+        for (const auto &kv : other) t.remove(kv.key);
+        return static_cast<long long>(t.size());
+    });
+    run("diff join", ops, [&] {
+        AVLMap<int, int> t(a.begin(), a.end());
+        avl_set::difference(t, other);
+        return static_cast<long long>(t.size());
+    });
+}
+
+}   // namespace
+
+int main() {
+    // 放在最前面，避免前面百万级的测试把堆打散后影响小树的结果
+    const size_t trees = 2000, size = 1000;
+    std::printf("build + clear, %zu trees of %zu keys\n", trees, size);
+    run("Map heap", trees * size, [&] {
+        return build_and_clear<Map<int, int, HeapNodes>>(trees, size);
+    });
+    run("Map arena", trees * size, [&] {
+        return build_and_clear<Map<int, int>>(trees, size);
+    });
+    run("AVL heap", trees * size, [&] {
+        return build_and_clear<AVLMap<int, int, HeapNodes>>(trees, size);
+    });
+    run("AVL arena", trees * size, [&] {
+        return build_and_clear<AVLMap<int, int>>(trees, size);
+    });
+
+    const size_t     n = 1000000;
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    compare("sorted", keys);
+    std::reverse(keys.begin(), keys.end());
+    compare("reverse sorted", keys);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    compare("random", keys);
+    avl_ops(std::vector<int>(keys.begin(), keys.begin() + 16384));
+    avl_ops(keys);
+
+    std::vector<std::pair<int, int>> items(n);
+    for (size_t i = 0; i < n; ++i) {
+        items[i] = {static_cast<int>(i), static_cast<int>(i)};
+    }
+    reload(items);
+    btree_ops(keys);
+    layouts(std::vector<int>(keys.begin(), keys.begin() + 65536));
+    layouts(keys);
+    set_ops(n, n);
+    set_ops(n, 1000);
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "MpmcQueue.hpp"
+#include "MyQueue.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 对照组：互斥锁加两个条件变量的有界队列
+class LockedQueue {
+public:
+    explicit LockedQueue(size_t capacity)
+        : capacity_(capacity), mutex_(), not_empty_(), not_full_(), queue_() {}
+
+    void push(int value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&] { return queue_.size() < capacity_; });
+        queue_.push(value);
+        not_empty_.notify_one();
+    }
+
+    void pop(int &out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return !queue_.empty(); });
+        out = queue_.front();
+        queue_.pop();
+        not_full_.notify_one();
+    }
+
+private:
+    size_t                  capacity_;
+    std::mutex              mutex_;
+    std::condition_variable not_empty_, not_full_;
+    RingQueue<int>          queue_;
+};
+
+// threads 个生产者和 threads 个消费者共传递 total 个元素
+template<typename Queue>
+void run(const char *name, size_t threads, size_t total) {
+    Queue                    q(1024);
+    const size_t             per = total / threads;
+    std::vector<std::thread> pool;
+    std::vector<long long>   sums(threads, 0);
+    auto                     start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&q, per] {
+            for (size_t i = 0; i < per; ++i) q.push(static_cast<int>(i));
+        });
+        pool.emplace_back([&q, &sums, per, t] {
+            int v = 0;
+            for (size_t i = 0; i < per; ++i) {
+                q.pop(v);
+                sums[t] += v;
+            }
+        });
+    }
+    for (auto &th : pool) th.join();
+    auto   stop = std::chrono::steady_clock::now();
+    double sec  = std::chrono::duration<double>(stop - start).count();
+    long long sink = 0;
+    for (long long s : sums) sink += s;
+    std::printf(
+        "  %-10s %2zu x %-2zu %8.2f Mops/s (sink %lld)\n", name, threads,
+        threads, double(per * threads) / sec / 1e6, sink);
+}
+
+}   // namespace
+
+int main() {
+    const size_t total = 4000000;
+    const size_t max_threads =
+        std::max<size_t>(2, std::thread::hardware_concurrency());
+    std::printf("producers x consumers, %zu items\n", total);
+    for (size_t t = 1; t <= max_threads; t *= 2) {
+        run<MpmcQueue<int>>("MpmcQueue", t, total);
+        run<LockedQueue>("mutex+cv", t, total);
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "MyArray.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// 统计全局堆分配次数
+static size_t g_allocations = 0;
+
+void* operator new(size_t n) {
+    ++g_allocations;
+    if (void* p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+template<typename Fn> void run(const char* name, size_t rounds, Fn&& fn) {
+    size_t     before = g_allocations;
+    auto       start  = std::chrono::steady_clock::now();
+    long long  sink   = 0;
+    for (size_t i = 0; i < rounds; ++i) {
+        sink += fn(i);
+    }
+    auto   stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    std::printf(
+        "%-28s %8.2f ns/op %8.3f allocs/op (sink %lld)\n", name,
+        ns / double(rounds),
+        double(g_allocations - before) / double(rounds), sink);
+}
+
+// 模拟请求路径上的小数组：构造、追加 n 个元素、遍历、析构
+template<typename Array> long long small_array(size_t n) {
+    Array arr;
+    arr.clear();   // MyArray 默认构造会填入 SIZE 个元素
+    for (size_t i = 0; i < n; ++i) {
+        arr.push_back(static_cast<int>(i));
+    }
+    long long sum = 0;
+    for (int x : arr) {
+        sum += x;
+    }
+    return sum;
+}
+
+}   // namespace
+
+int main() {
+    const size_t rounds = 2000000;
+    for (size_t n : {2, 4, 8}) {
+        std::printf("-- %zu elements --\n", n);
+        run("MyArray<int, 0>", rounds, [n](size_t) {
+            return small_array<MyArray<int, 0>>(n);
+        });
+        run("MyArray<int, 4>", rounds, [n](size_t) {
+            return small_array<MyArray<int, 4>>(n);
+        });
+        run("MyArray<int, 8>", rounds, [n](size_t) {
+            return small_array<MyArray<int, 8>>(n);
+        });
+        run("std::vector<int>", rounds, [n](size_t) {
+            return small_array<std::vector<int>>(n);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "MyList.hpp"
+#include "MyQueue.hpp"
+#include "UnrolledList.hpp"
+#include <chrono>
+#include <cstdio>
+#include <list>
+#include <memory>
+
+namespace {
+
+// 改写前的 MyList 核心：节点之间用 shared_ptr 双向链接
+template<typename T> class LegacyList {
+public:
+    LegacyList() : head_(), tail_(), num_items_(0) {}
+    LegacyList(const LegacyList &)            = delete;
+    LegacyList &operator=(const LegacyList &) = delete;
+    ~LegacyList() {
+        while (tail_) pop_back();
+    }
+
+    void push_back(const T &elm) {
+        auto node = std::make_shared<Node>(elm);
+        if (!tail_) {
+            head_ = node;
+        } else {
+            tail_->nxt_ = node;
+            node->lst_  = tail_;
+        }
+        tail_ = node;
+        ++num_items_;
+    }
+
+    void pop_back() {
+        if (tail_->lst_) {
+            tail_ = tail_->lst_;
+            tail_->nxt_.reset();
+        } else {
+            head_.reset();
+            tail_.reset();
+        }
+        --num_items_;
+    }
+
+    void pop_front() {
+        if (head_->nxt_) {
+            head_ = head_->nxt_;
+            head_->lst_.reset();
+        } else {
+            head_.reset();
+            tail_.reset();
+        }
+        --num_items_;
+    }
+
+    T &front() { return head_->value_; }
+
+    template<typename Fn> void for_each(Fn &&fn) {
+        for (auto p = head_; p; p = p->nxt_) fn(p->value_);
+    }
+
+private:
+    struct Node {
+        explicit Node(const T &v) : lst_(), nxt_(), value_(v) {}
+        std::shared_ptr<Node> lst_, nxt_;
+        T                     value_;
+    };
+    std::shared_ptr<Node> head_, tail_;
+    size_t                num_items_;
+};
+
+template<typename Fn> void run(const char *name, size_t ops, Fn &&fn) {
+    auto      start = std::chrono::steady_clock::now();
+    long long sink  = fn();
+    auto      stop  = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    std::printf(
+        "  %-12s %8.2f ns/op (sink %lld)\n", name, ns / double(ops), sink);
+}
+
+// 追加 n 个元素、遍历一次、再从头部全部弹出
+template<typename List> long long fill_scan_drain(size_t n) {
+    List      lst;
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i) lst.push_back(static_cast<int>(i));
+    for (int x : lst) sum += x;
+    for (size_t i = 0; i < n; ++i) {
+        sum += lst.front();
+        lst.pop_front();
+    }
+    return sum;
+}
+
+template<> long long fill_scan_drain<LegacyList<int>>(size_t n) {
+    LegacyList<int> lst;
+    long long       sum = 0;
+    for (size_t i = 0; i < n; ++i) lst.push_back(static_cast<int>(i));
+    lst.for_each([&](int x) { sum += x; });
+    for (size_t i = 0; i < n; ++i) {
+        sum += lst.front();
+        lst.pop_front();
+    }
+    return sum;
+}
+
+// 元素数量稳定的 FIFO：每轮 push 一个、pop 一个
+template<typename List> long long steady_queue(size_t depth, size_t rounds) {
+    List      lst;
+    long long sum = 0;
+    for (size_t i = 0; i < depth; ++i) lst.push_back(static_cast<int>(i));
+    for (size_t i = 0; i < rounds; ++i) {
+        lst.push_back(static_cast<int>(i));
+        sum += lst.front();
+        lst.pop_front();
+    }
+    return sum;
+}
+
+// 重复遍历求和
+template<typename List> long long scan(const List &lst, size_t reps) {
+    long long sum = 0;
+    for (size_t r = 0; r < reps; ++r) {
+        for (int x : lst) sum += x;
+    }
+    return sum;
+}
+
+// 按步长做下标访问
+template<typename List> long long indexed(List &lst, size_t lookups) {
+    long long sum = 0;
+    size_t    idx = 0;
+    for (size_t i = 0; i < lookups; ++i) {
+        sum += lst[idx];
+        idx = (idx + 7919) % lst.size();
+    }
+    return sum;
+}
+
+}   // namespace
+
+int main() {
+    const size_t n = 1000000;
+    std::printf("fill + scan + drain, %zu elements\n", n);
+    run("legacy", n, [&] { return fill_scan_drain<LegacyList<int>>(n); });
+    run("MyList", n, [&] { return fill_scan_drain<MyList<int>>(n); });
+    run("std::list", n, [&] { return fill_scan_drain<std::list<int>>(n); });
+    run("Unrolled", n, [&] { return fill_scan_drain<UnrolledList<int>>(n); });
+
+    const size_t depth = 1024, rounds = 5000000;
+    std::printf("steady queue, depth %zu, %zu rounds\n", depth, rounds);
+    run("legacy", rounds, [&] {
+        return steady_queue<LegacyList<int>>(depth, rounds);
+    });
+    run("MyList", rounds, [&] {
+        return steady_queue<MyList<int>>(depth, rounds);
+    });
+    run("std::list", rounds, [&] {
+        return steady_queue<std::list<int>>(depth, rounds);
+    });
+    run("Unrolled", rounds, [&] {
+        return steady_queue<UnrolledList<int>>(depth, rounds);
+    });
+
+    // 交错插入两个链表，使节点在内存中不连续，更接近长期运行后的状态
+    MyList<int>       plain, other;
+    UnrolledList<int> unrolled;
+    for (size_t i = 0; i < n; ++i) {
+        plain.push_back(static_cast<int>(i));
+        other.push_back(static_cast<int>(i));
+        unrolled.push_back(static_cast<int>(i));
+    }
+    const size_t reps = 20;
+    std::printf("scan, %zu elements x %zu\n", n, reps);
+    run("MyList", n * reps, [&] { return scan(plain, reps); });
+    run("Unrolled", n * reps, [&] { return scan(unrolled, reps); });
+
+    const size_t lookups = 2000;
+    std::printf("operator[], %zu lookups\n", lookups);
+    run("MyList", lookups, [&] { return indexed(plain, lookups); });
+    run("Unrolled", lookups, [&] { return indexed(unrolled, lookups); });
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "MyQueue.hpp"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+template<typename Fn> void run(const char *name, size_t ops, Fn &&fn) {
+    auto      start = std::chrono::steady_clock::now();
+    long long sink  = fn();
+    auto      stop  = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    std::printf(
+        "  %-12s %8.2f ns/op (sink %lld)\n", name, ns / double(ops), sink);
+}
+
+// 元素数量稳定的 FIFO：每轮 push 一个、pop 一个
+template<typename Queue> long long steady(size_t depth, size_t rounds) {
+    Queue     q;
+    long long sum = 0;
+    for (size_t i = 0; i < depth; ++i) q.push(static_cast<int>(i));
+    for (size_t i = 0; i < rounds; ++i) {
+        q.push(static_cast<int>(i));
+        sum += q.front();
+        q.pop();
+    }
+    return sum;
+}
+
+// 先全部入队再全部出队，包含扩容开销
+template<typename Queue> long long fill_drain(size_t n) {
+    Queue     q;
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i) q.push(static_cast<int>(i));
+    while (!q.empty()) {
+        sum += q.front();
+        q.pop();
+    }
+    return sum;
+}
+
+// 每次批量搬运 batch 个元素
+template<typename Queue> long long batched(size_t batch, size_t rounds) {
+    Queue            q;
+    std::vector<int> in(batch), out(batch);
+    long long        sum = 0;
+    for (size_t i = 0; i < batch; ++i) in[i] = static_cast<int>(i);
+    for (size_t r = 0; r < rounds; ++r) {
+        q.push_range(in.begin(), in.end());
+        q.pop_into(out.begin(), batch);
+        sum += out[r % batch];
+    }
+    return sum;
+}
+
+}   // namespace
+
+int main() {
+    const size_t depth = 1024, rounds = 10000000;
+    std::printf("steady queue, depth %zu, %zu rounds\n", depth, rounds);
+    run("MyList", rounds, [&] { return steady<MyQueue<int>>(depth, rounds); });
+    run("RingBuffer", rounds, [&] {
+        return steady<RingQueue<int>>(depth, rounds);
+    });
+
+    const size_t n = 5000000;
+    std::printf("fill + drain, %zu elements\n", n);
+    run("MyList", n, [&] { return fill_drain<MyQueue<int>>(n); });
+    run("RingBuffer", n, [&] { return fill_drain<RingQueue<int>>(n); });
+
+    const size_t batch = 256, batches = 50000;
+    std::printf("push_range + pop_into, batch %zu\n", batch);
+    run("MyList", batch * batches, [&] {
+        return batched<MyQueue<int>>(batch, batches);
+    });
+    run("RingBuffer", batch * batches, [&] {
+        return batched<RingQueue<int>>(batch, batches);
+    });
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "MyList.hpp"
+#include "MyStack.hpp"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+template<typename Fn> void run(const char *name, size_t ops, Fn &&fn) {
+    auto      start = std::chrono::steady_clock::now();
+    long long sink  = fn();
+    auto      stop  = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    std::printf(
+        "  %-12s %8.2f ns/op (sink %lld)\n", name, ns / double(ops), sink);
+}
+
+// 模拟表达式求值：反复压入几个操作数再弹出合并，栈深度来回波动
+template<typename Stack> long long evaluate(size_t rounds) {
+    Stack     st;
+    long long sum = 0;
+    for (size_t r = 0; r < rounds; ++r) {
+        const int depth = static_cast<int>(r % 64) + 1;
+        for (int i = 0; i < depth; ++i) st.push(i);
+        while (st.size() > 1) {
+            int rhs = st.top();
+            st.pop();
+            st.top() += rhs;
+        }
+        sum += st.top();
+        st.pop();
+    }
+    return sum;
+}
+
+// 一次压入 n 个再全部弹出
+template<typename Stack> long long fill_drain(size_t n, bool reserve) {
+    Stack st;
+    if (reserve) st.reserve(n);
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i) st.push(static_cast<int>(i));
+    while (!st.empty()) {
+        sum += st.top();
+        st.pop();
+    }
+    return sum;
+}
+
+}   // namespace
+
+int main() {
+    using ListStack = MyStack<int, MyList<int>>;
+
+    const size_t rounds = 200000, ops = rounds * 65;
+    std::printf("expression evaluation, %zu rounds\n", rounds);
+    run("MyList", ops, [&] { return evaluate<ListStack>(rounds); });
+    run("Segmented", ops, [&] { return evaluate<MyStack<int>>(rounds); });
+
+    const size_t n = 5000000;
+    std::printf("fill + drain, %zu elements\n", n);
+    run("MyList", n, [&] { return fill_drain<ListStack>(n, false); });
+    run("Segmented", n, [&] { return fill_drain<MyStack<int>>(n, false); });
+    run("reserved", n, [&] { return fill_drain<MyStack<int>>(n, true); });
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "MyArrayAlgorithm.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+// 对每个指令集重复执行 fn，输出每秒处理的元素数
+template<typename T, typename Fn>
+void run(const char* name, const MyArray<T>& arr, Fn&& fn) {
+    const int reps = 200;
+    std::printf("%-6s", name);
+    for (simd::Isa isa :
+         {simd::Isa::Scalar, simd::Isa::SSE42, simd::Isa::AVX2}) {
+        if (!simd::isa_supported(isa)) {
+            std::printf(" %10s: %8s", simd::isa_name(isa), "n/a");
+            continue;
+        }
+        const auto& k     = simd::kernels<T>(isa);
+        double      sink  = 0;
+        auto        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            sink += static_cast<double>(fn(k));
+        }
+        auto   stop = std::chrono::steady_clock::now();
+        double sec  = std::chrono::duration<double>(stop - start).count();
+        double rate = double(arr.size()) * reps / sec / 1e9;
+        std::printf(" %10s: %6.2f G/s", simd::isa_name(isa), rate);
+        if (sink == 0.5) std::printf("!");   // 防止结果被优化掉
+    }
+    std::printf("\n");
+}
+
+template<typename T>
+void bench(const char* type, MyArray<T>& a, MyArray<T>& b) {
+    std::printf("== %s, %zu elements ==\n", type, a.size());
+    const T* first = a.begin();
+    const T* last  = a.end();
+    const T  miss  = T(-12345);
+    run("find", a, [&](const auto& k) {
+        return k.find(first, last, miss) - first;
+    });
+    run("count", a, [&](const auto& k) { return k.count(first, last, a[7]); });
+    run("min", a, [&](const auto& k) { return k.min(first, last); });
+    run("max", a, [&](const auto& k) { return k.max(first, last); });
+    run("sum", a, [&](const auto& k) { return k.sum(first, last); });
+    run("dot", a, [&](const auto& k) { return k.dot(first, last, b.begin()); });
+}
+
+}   // namespace
+
+int main() {
+    const size_t                       n = 1 << 20;
+    std::mt19937                       rng(1);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+
+    MyArray<int>   ia, ib;
+    MyArray<float> fa, fb;
+    ia.reserve(n);
+    ib.reserve(n);
+    fa.reserve(n);
+    fb.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        ia.push_back(dist(rng));
+        ib.push_back(dist(rng));
+        fa.push_back(static_cast<float>(dist(rng)) / 1000.0f);
+        fb.push_back(static_cast<float>(dist(rng)) / 1000.0f);
+    }
+
+    bench("int", ia, ib);
+    bench("float", fa, fb);
+    return 0;
+}
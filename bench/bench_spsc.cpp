@@ -0,0 +1,135 @@
+#include "MyQueue.hpp"
+#include "SpscQueue.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ns_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start)
+        .count();
+}
+
+// 对照组：互斥锁保护的 MyQueue
+class LockedQueue {
+public:
+    LockedQueue() : mutex_(), queue_() {}
+
+    bool push(int value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(value);
+        return true;
+    }
+
+    bool pop(int &out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) {
+            return false;
+        }
+        out = queue_.front();
+        queue_.pop();
+        return true;
+    }
+
+private:
+    std::mutex   mutex_;
+    MyQueue<int> queue_;
+};
+
+template<typename Queue> void throughput(const char *name, size_t n) {
+    Queue       q;
+    auto        start = Clock::now();
+    std::thread producer([&] {
+        for (size_t i = 0; i < n; ++i) {
+            while (!q.push(static_cast<int>(i))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    long long sum = 0;
+    int       v   = 0;
+    for (size_t i = 0; i < n; ++i) {
+        while (!q.pop(v)) {
+            std::this_thread::yield();
+        }
+        sum += v;
+    }
+    producer.join();
+    std::printf(
+        "  %-12s %8.2f ns/item (sink %lld)\n", name,
+        ns_since(start) / double(n), sum);
+}
+
+struct Spsc : SpscQueue<int> {
+    Spsc() : SpscQueue<int>(4096) {}
+};
+
+// 批量入队出队，每批 batch 个
+void batched(size_t n, size_t batch) {
+    Spsc        q;
+    auto        start = Clock::now();
+    std::thread producer([&] {
+        std::vector<int> in(batch);
+        for (size_t sent = 0; sent < n;) {
+            size_t k = std::min(batch, n - sent);
+            for (size_t i = 0; i < k; ++i) in[i] = static_cast<int>(sent + i);
+            size_t pushed = q.push_range(in.begin(), in.begin() + long(k));
+            if (pushed == 0) std::this_thread::yield();
+            sent += pushed;
+        }
+    });
+    std::vector<int> out(batch);
+    long long        sum = 0;
+    for (size_t got = 0; got < n;) {
+        size_t k = q.pop_into(out.begin(), batch);
+        if (k == 0) std::this_thread::yield();
+        for (size_t i = 0; i < k; ++i) sum += out[i];
+        got += k;
+    }
+    producer.join();
+    std::printf(
+        "  batch %-6zu %8.2f ns/item (sink %lld)\n", batch,
+        ns_since(start) / double(n), sum);
+}
+
+// 两个队列来回传递一个值，测单程延迟
+void ping_pong(size_t rounds) {
+    SpscQueue<int> ping(64), pong(64);
+    std::thread    echo([&] {
+        int v = 0;
+        for (size_t i = 0; i < rounds; ++i) {
+            while (!ping.pop(v)) std::this_thread::yield();
+            pong.push(v);
+        }
+    });
+    auto start = Clock::now();
+    int  v     = 0;
+    for (size_t i = 0; i < rounds; ++i) {
+        ping.push(static_cast<int>(i));
+        while (!pong.pop(v)) std::this_thread::yield();
+    }
+    double ns = ns_since(start);
+    echo.join();
+    std::printf("  one-way latency %8.2f ns\n", ns / double(rounds) / 2);
+}
+
+}   // namespace
+
+int main() {
+    const size_t n = 20000000;
+    std::printf("producer -> consumer, %zu items\n", n);
+    throughput<Spsc>("SpscQueue", n);
+    throughput<LockedQueue>("mutex+list", n / 10);
+    for (size_t batch : {16, 256}) batched(n, batch);
+
+    std::printf("ping-pong\n");
+    ping_pong(1000000);
+    return 0;
+}
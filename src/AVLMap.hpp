@@ -1,6 +1,9 @@
 #pragma once
+#include "NodePool.hpp"
+#include "SortedInput.hpp"
 #include <functional>
 #include <iostream>
+#include <type_traits>
 #include <vector>
 
 template<typename Key, typename Value>
@@ -8,34 +11,277 @@ struct AVLNode {
     Key      key;
     Value    value;
     int      height;
+    size_t   size;   // 以该节点为根的子树中的节点数
     AVLNode* left;
     AVLNode* right;
 
     AVLNode(const Key& key, const Value& value)
-        : key(key), value(value), height(1), left(nullptr), right(nullptr) {}
+        : key(key)
+        , value(value)
+        , height(1)
+        , size(1)
+        , left(nullptr)
+        , right(nullptr) {}
+    AVLNode(const AVLNode& other) = default;
+    AVLNode& operator=(const AVLNode& other) = default;
 };
 
-template<typename Key, typename Value>
+namespace avl_set {
+template<typename Key, typename Value, typename Alloc> class Ops;
+}
+
+// Alloc 决定节点从哪里分配，默认来自连续的内存块，见 NodePool.hpp。
+// 并集、交集等集合运算见 AVLSetOps.hpp
+template<typename Key, typename Value, typename Alloc = ArenaNodes>
 class AVLMap {
     using Node = AVLNode<Key, Value>;
+    using Pool = typename Alloc::template Pool<Node>;
 
 public:
-    AVLMap() : root(nullptr) {}
+    AVLMap() : root(nullptr), nodes_() {}
+
+    // 从 (key, value) 序列建树，见 assign_sorted
+    template<typename It> AVLMap(It first, It last) : AVLMap() {
+        assign_sorted(first, last);
+    }
+
     AVLMap(const AVLMap& other) = delete;
     AVLMap(AVLMap&& other) = delete;
     AVLMap& operator=(const AVLMap& other) = delete;
     AVLMap& operator=(AVLMap&& other) = delete;
 
+    // 沿途记录经过的子指针位置，插入后自底向上更新高度并旋转
     void put(const Key& key, const Value& value) {
-        root = insertNode(root, key, value);
+        Node** path[max_height];
+        size_t depth = 0;
+        Node** link  = &root;
+        while (Node* node = *link) {
+            path[depth++] = link;
+            if (key < node->key) {
+                link = &node->left;
+            } else if (node->key < key) {
+                link = &node->right;
+            } else {
+                node->value = value;
+                return;
+            }
+        }
+        *link = nodes_.create(key, value);
+        rebalancePath(path, depth);
+    }
+
+    // 用 (key, value) 序列替换全部内容。键严格递增时直接 O(n) 建出
+    // 完全平衡的树，否则先拷贝、排序、去重（重复的键保留最后一个值）
+    template<typename It> void assign_sorted(It first, It last) {
+        clear();
+        if (sorted_input::usable_in_place(first, last)) {
+            size_t n = static_cast<size_t>(std::distance(first, last));
+            root = buildSubtree(first, n);
+        } else {
+            auto items = sorted_input::sort_unique<Key, Value>(first, last);
+            auto it    = items.cbegin();
+            root = buildSubtree(it, items.size());
+        }
     }
 
     Value* get(const Key& key) const {
-        return searchNode(root, key);
+        Node* node = root;
+        while (node) {
+            if (key < node->key) {
+                node = node->left;
+            } else if (node->key < key) {
+                node = node->right;
+            } else {
+                return &node->value;
+            }
+        }
+        return nullptr;
     }
 
+    // 有两个子节点时把后继节点整个接到被删节点的位置上，不拷贝键值
     void remove(const Key& key) {
-        root = deleteNode(root, key);
+        Node** path[max_height];
+        size_t depth = 0;
+        Node** link  = &root;
+        while (*link && (key < (*link)->key || (*link)->key < key)) {
+            path[depth++] = link;
+            link = key < (*link)->key ? &(*link)->left : &(*link)->right;
+        }
+        Node* node = *link;
+        if (!node) return;
+
+        if (!node->left || !node->right) {
+            *link = node->left ? node->left : node->right;
+        } else {
+            path[depth++] = link;
+            const size_t nodeDepth = depth;
+            Node** succLink = &node->right;
+            while ((*succLink)->left) {
+                path[depth++] = succLink;
+                succLink = &(*succLink)->left;
+            }
+            Node* succ = *succLink;
+            *succLink = succ->right;
+            succ->left = node->left;
+            succ->right = node->right;
+            *link = succ;
+            // 后继的父指针位置原本在 node 里，node 已被后继取代
+            if (depth > nodeDepth) {
+                path[nodeDepth] = &succ->right;
+            }
+        }
+        nodes_.destroy(node);
+        rebalancePath(path, depth);
+    }
+
+    // 中序迭代器。没有父指针，栈里保存尚未访问的祖先，栈顶是当前节点
+    class Iterator {
+    public:
+        Iterator() : path() {}
+
+        // 只读：改动键、高度或子指针会破坏树的顺序和平衡
+        const Node& operator*() const { return *path.back(); }
+
+        const Node* operator->() const { return path.back(); }
+
+        Iterator& operator++() {
+            Node* node = path.back()->right;
+            path.pop_back();
+            pushLeftSpine(node);
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return current() == other.current();
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return current() != other.current();
+        }
+
+    private:
+        friend class AVLMap;
+
+        Node* current() const { return path.empty() ? nullptr : path.back(); }
+
+        void pushLeftSpine(Node* node) {
+            for (; node; node = node->left) {
+                path.push_back(node);
+            }
+        }
+
+        std::vector<Node*> path;
+    };
+
+    Iterator begin() const {
+        Iterator it;
+        it.pushLeftSpine(root);
+        return it;
+    }
+
+    Iterator end() const { return Iterator(); }
+
+    // 第一个键不小于 key 的元素
+    Iterator lower_bound(const Key& key) const {
+        Iterator it;
+        for (Node* node = root; node;) {
+            if (node->key < key) {
+                node = node->right;
+            } else {
+                it.path.push_back(node);
+                node = node->left;
+            }
+        }
+        return it;
+    }
+
+    // 第一个键大于 key 的元素
+    Iterator upper_bound(const Key& key) const {
+        Iterator it;
+        for (Node* node = root; node;) {
+            if (key < node->key) {
+                it.path.push_back(node);
+                node = node->left;
+            } else {
+                node = node->right;
+            }
+        }
+        return it;
+    }
+
+    std::pair<Iterator, Iterator> equal_range(const Key& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // 一段迭代器区间，可以直接用于范围 for
+    struct Range {
+        Iterator first;
+        Iterator last;
+
+        Iterator begin() const { return first; }
+        Iterator end() const { return last; }
+    };
+
+    // 键在 [lo, hi) 内的元素，按顺序遍历，不拷贝数据，代价 O(log n + k)
+    Range range(const Key& lo, const Key& hi) const {
+        if (!(lo < hi)) {
+            return Range{end(), end()};
+        }
+        return Range{lower_bound(lo), lower_bound(hi)};
+    }
+
+    size_t size() const { return getSize(root); }
+
+    bool empty() const { return root == nullptr; }
+
+    // 键小于 key 的元素个数，O(log n)
+    size_t rank(const Key& key) const {
+        size_t result = 0;
+        for (Node* node = root; node;) {
+            if (node->key < key) {
+                result += getSize(node->left) + 1;
+                node = node->right;
+            } else {
+                node = node->left;
+            }
+        }
+        return result;
+    }
+
+    // 第 i 小（从 0 开始）的元素，越界时返回 end()，O(log n)
+    Iterator select(size_t i) const {
+        Iterator it;
+        if (i >= size()) {
+            return it;
+        }
+        for (Node* node = root; node;) {
+            size_t leftSize = getSize(node->left);
+            if (i < leftSize) {
+                it.path.push_back(node);
+                node = node->left;
+            } else if (i > leftSize) {
+                i -= leftSize + 1;
+                node = node->right;
+            } else {
+                it.path.push_back(node);
+                break;
+            }
+        }
+        return it;
+    }
+
+    // 键在 [lo, hi) 内的元素个数，O(log n)
+    size_t count_range(const Key& lo, const Key& hi) const {
+        if (!(lo < hi)) {
+            return 0;
+        }
+        return rank(hi) - rank(lo);
     }
 
     std::vector<std::pair<Key, Value>> inorder() const {
@@ -44,19 +290,29 @@ public:
         return res;
     }
 
+    // 清空所有节点。节点无需析构且来自内存块时直接整块归还，不逐个访问
+    void clear() {
+        if constexpr (!(Pool::bulk_release
+                        && std::is_trivially_destructible_v<Node>)) {
+            destroyTree(root);
+        }
+        nodes_.release();
+        root = nullptr;
+    }
+
     ~AVLMap() {
-        destroyTree(root);
+        clear();
     }
 
 private:
-    Node* root;
+    friend class avl_set::Ops<Key, Value, Alloc>;
 
-    Node* getMinimumNode(Node* node) const {
-        while (node && node->left) {
-            node = node->left;
-        }
-        return node;
-    }
+    // AVL 树高度不超过 1.44 log2(n + 2)，
+    // 64 位地址空间放得下的节点数达不到这个深度
+    static constexpr size_t max_height = 96;
+
+    Node* root;
+    Pool  nodes_;
 
     void inorderHelper(Node* node, std::vector<std::pair<Key, Value>>& res) const {
         if (!node) return;
@@ -65,32 +321,8 @@ private:
         inorderHelper(node->right, res);
     }
 
-    Node* balanceInsert(Node* node, const Key& key) {
-        int balance = getBalance(node);
-
-        // Left Left (LL)
-        if (balance > 1 && key < node->left->key) {
-            return rightRotate(node);
-        }
-        // Right Right (RR)
-        if (balance < -1 && key > node->right->key) {
-            return leftRotate(node);
-        }
-        // Left Right (LR)
-        if (balance > 1 && key > node->left->key) {
-            node->left = leftRotate(node->left);
-            return rightRotate(node);
-        }
-        // Right Left (RL)
-        if (balance < -1 && key < node->right->key) {
-            node->right = rightRotate(node->right);
-            return leftRotate(node);
-        }
-
-        return node;
-    }
-
-    Node* balanceDelete(Node* node) {
+    // 左右高度差超过 1 时旋转，返回旋转后的子树根
+    Node* rebalance(Node* node) {
         int balance = getBalance(node);
 
         // Left Left (LL)
@@ -119,6 +351,10 @@ private:
         return node ? node->height : 0;
     }
 
+    size_t getSize(Node* node) const {
+        return node ? node->size : 0;
+    }
+
     int getBalance(Node* node) const {
         return node ? getHeight(node->left) - getHeight(node->right) : 0;
     }
@@ -146,6 +382,8 @@ private:
 
         y->height = std::max(getHeight(y->left), getHeight(y->right)) + 1;
         x->height = std::max(getHeight(x->left), getHeight(x->right)) + 1;
+        y->size = 1 + getSize(y->left) + getSize(y->right);
+        x->size = 1 + getSize(x->left) + getSize(x->right);
 
         return x;
     }
@@ -169,75 +407,52 @@ private:
 
         x->height = std::max(getHeight(x->left), getHeight(x->right)) + 1;
         y->height = std::max(getHeight(y->left), getHeight(y->right)) + 1;
+        x->size = 1 + getSize(x->left) + getSize(x->right);
+        y->size = 1 + getSize(y->left) + getSize(y->right);
 
         return y;
     }
 
-    Node* insertNode(Node* node, const Key& key, const Value& value) {
-        if (!node) {
-            return new Node(key, value);
-        }
-
-        if (key < node->key) {
-            node->left = insertNode(node->left, key, value);
-        } else if (key > node->key) {
-            node->right = insertNode(node->right, key, value);
-        } else {
-            node->value = value; // Update value if key exists
-            return node;
-        }
-
+    // 由子节点重新计算高度和子树大小
+    void update(Node* node) {
         node->height = 1 + std::max(getHeight(node->left), getHeight(node->right));
-        return balanceInsert(node, key);
+        node->size = 1 + getSize(node->left) + getSize(node->right);
     }
 
-    Value* searchNode(Node* node, const Key& key) const {
-        if (!node) {
-            return nullptr;
-        }
-
-        if (key < node->key) {
-            return searchNode(node->left, key);
-        } else if (key > node->key) {
-            return searchNode(node->right, key);
-        } else {
-            return &(node->value);
+    // 从最深处向上重新计算高度和子树大小，需要时旋转后写回父节点
+    void rebalancePath(Node** path[], size_t depth) {
+        while (depth > 0) {
+            Node** link = path[--depth];
+            Node* node = *link;
+            update(node);
+            *link = rebalance(node);
         }
     }
 
-    Node* deleteNode(Node* node, const Key& key) {
-        if (!node) return node;
+    // 按中序依次消耗输入，左子树先取走前一半，左右子树大小至多差一
+    template<typename It> Node* buildSubtree(It& it, size_t n) {
+        if (n == 0) return nullptr;
+        Node* left = buildSubtree(it, n / 2);
+        Node* node = nodes_.create(it->first, it->second);
+        ++it;
+        node->left = left;
+        node->right = buildSubtree(it, n - n / 2 - 1);
+        update(node);
+        return node;
+    }
 
-        if (key < node->key) {
-            node->left = deleteNode(node->left, key);
-        } else if (key > node->key) {
-            node->right = deleteNode(node->right, key);
-        } else {
-            if (!node->left || !node->right) {
-                Node* temp = node->left ? node->left : node->right;
-                if (!temp) {
-                    delete node;
-                    return nullptr;
-                } else {
-                    *node = *temp;
-                    delete temp;
-                }
+    // 迭代地删除节点：有左子树就右旋把它提上来，否则删除当前节点转向右子树
+    void destroyTree(Node* node) {
+        while (node) {
+            if (Node* left = node->left) {
+                node->left = left->right;
+                left->right = node;
+                node = left;
             } else {
-                Node* temp = getMinimumNode(node->right);
-                node->key = temp->key;
-                node->value = temp->value;
-                node->right = deleteNode(node->right, temp->key);
+                Node* right = node->right;
+                nodes_.destroy(node);
+                node = right;
             }
         }
-
-        node->height = 1 + std::max(getHeight(node->left), getHeight(node->right));
-        return balanceDelete(node);
-    }
-
-    void destroyTree(Node* node) {
-        if (!node) return;
-        destroyTree(node->left);
-        destroyTree(node->right);
-        delete node;
     }
 };
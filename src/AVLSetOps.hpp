@@ -0,0 +1,295 @@
+#pragma once
+#include "AVLMap.hpp"
+#include "ThreadPool.hpp"
+#include <mutex>
+
+// AVLMap 的集合运算，都基于 split / join。m 和 n 分别是较小和较大的一方时
+// 代价 O(m log(n / m + 1))；规模较大时左右两半在 ThreadPool 上并行执行。
+// 单独放在这个头文件里，只用 AVLMap 的代码不必依赖线程池
+namespace avl_set {
+
+// 一次集合运算的上下文。并行的子任务处理互不相交的子树，
+// 只有节点池是共享的，申请和释放节点时加锁
+template<typename Key, typename Value, typename Alloc> class Ops {
+    using Map  = AVLMap<Key, Value, Alloc>;
+    using Node = AVLNode<Key, Value>;
+
+    // 两边合计不到这么多节点时不再拆分任务
+    static constexpr size_t parallel_grain = 4096;
+
+public:
+    explicit Ops(Map& map) : map_(map), lock_() {}
+
+    Ops(const Ops& other) = delete;
+    Ops& operator=(const Ops& other) = delete;
+
+    // 先把 other 整个复制到本对象的节点池，复制失败时释放已复制的节点，
+    // 本对象不变；之后的合并只移动指针、释放重复的节点，不会再失败
+    void unionWith(const Map& other) {
+        if (map_.size() + other.size() >= parallel_grain) {
+            ThreadPool::shared();   // 创建线程池可能失败，放在修改之前
+        }
+        Node* copy = copyTree(other.root);
+        map_.root  = unionNodes(map_.root, copy);
+    }
+
+    void intersectWith(const Map& other) {
+        map_.root = intersectNodes(map_.root, other.root);
+    }
+
+    void difference(const Map& other) {
+        map_.root = differenceNodes(map_.root, other.root);
+    }
+
+    template<typename Pred> void filter(Pred& pred) {
+        map_.root = filterNodes(map_.root, pred);
+    }
+
+private:
+    Map&       map_;
+    std::mutex lock_;
+
+    int getHeight(Node* node) const { return map_.getHeight(node); }
+
+    // ---- split / join ----
+
+    // left 比 right 高时沿 left 的右边界向下，找到与 right 高度相差
+    // 不超过 1 的子树，用 mid 把两者接起来，再逐层向上重新平衡
+    Node* joinRight(Node* left, Node* mid, Node* right) {
+        if (getHeight(left) <= getHeight(right) + 1) {
+            mid->left = left;
+            mid->right = right;
+            map_.update(mid);
+            return mid;
+        }
+        left->right = joinRight(left->right, mid, right);
+        map_.update(left);
+        return map_.rebalance(left);
+    }
+
+    Node* joinLeft(Node* left, Node* mid, Node* right) {
+        if (getHeight(right) <= getHeight(left) + 1) {
+            mid->left = left;
+            mid->right = right;
+            map_.update(mid);
+            return mid;
+        }
+        right->left = joinLeft(left, mid, right->left);
+        map_.update(right);
+        return map_.rebalance(right);
+    }
+
+    // left 的键都小于 mid，right 的键都大于 mid，拼成一棵树。
+    // 代价 O(|高度差| + 1)
+    Node* join(Node* left, Node* mid, Node* right) {
+        if (getHeight(left) > getHeight(right) + 1) {
+            return joinRight(left, mid, right);
+        }
+        if (getHeight(right) > getHeight(left) + 1) {
+            return joinLeft(left, mid, right);
+        }
+        mid->left = left;
+        mid->right = right;
+        map_.update(mid);
+        return mid;
+    }
+
+    // 按 key 把 node 拆成键更小的 left 和键更大的 right，
+    // 返回键等于 key 的节点（子指针已清空），没有时返回 nullptr。O(log n)
+    Node* split(Node* node, const Key& key, Node*& left, Node*& right) {
+        if (!node) {
+            left = right = nullptr;
+            return nullptr;
+        }
+        if (key < node->key) {
+            Node* inner = nullptr;
+            Node* found = split(node->left, key, left, inner);
+            right = join(inner, node, node->right);
+            return found;
+        }
+        if (node->key < key) {
+            Node* inner = nullptr;
+            Node* found = split(node->right, key, inner, right);
+            left = join(node->left, node, inner);
+            return found;
+        }
+        left = node->left;
+        right = node->right;
+        node->left = node->right = nullptr;
+        map_.update(node);
+        return node;
+    }
+
+    // 摘下 node 中最大的节点放进 last，返回剩下的树
+    Node* splitLast(Node* node, Node*& last) {
+        if (!node->right) {
+            Node* left = node->left;
+            node->left = nullptr;
+            map_.update(node);
+            last = node;
+            return left;
+        }
+        Node* rest = splitLast(node->right, last);
+        return join(node->left, node, rest);
+    }
+
+    // 没有中间节点的 join
+    Node* join2(Node* left, Node* right) {
+        if (!left) return right;
+        Node* last = nullptr;
+        Node* rest = splitLast(left, last);
+        return join(rest, last, right);
+    }
+
+    // ---- 并行执行 ----
+
+    template<typename F, typename G>
+    static void inParallel(size_t work, F&& first, G&& second) {
+        if (work >= parallel_grain) {
+            ThreadPool::shared().fork_join(first, second);
+        } else {
+            first();
+            second();
+        }
+    }
+
+    Node* allocate(const Key& key, const Value& value) {
+        std::lock_guard<std::mutex> guard(lock_);
+        return map_.nodes_.create(key, value);
+    }
+
+    void deallocate(Node* node) {
+        std::lock_guard<std::mutex> guard(lock_);
+        map_.nodes_.destroy(node);
+    }
+
+    void destroyTree(Node* node) {
+        std::lock_guard<std::mutex> guard(lock_);
+        map_.destroyTree(node);
+    }
+
+    // 把另一棵树的子树复制到本对象的节点池。
+    // 失败时已复制的节点都已释放，异常原样抛出
+    Node* copyTree(const Node* node) {
+        if (!node) return nullptr;
+        Node* copy = allocate(node->key, node->value);
+        try {
+            inParallel(
+                node->size,
+                [&] { copy->left = copyTree(node->left); },
+                [&] { copy->right = copyTree(node->right); });
+        } catch (...) {
+            destroyTree(copy);
+            throw;
+        }
+        copy->height = node->height;
+        copy->size = node->size;
+        return copy;
+    }
+
+    // 两棵树的节点都属于本对象。用 other 的根拆开 node，
+    // 两边分别递归合并后再用这个根接起来；键重复时释放 node 中的节点
+    Node* unionNodes(Node* node, Node* other) {
+        if (!other) return node;
+        if (!node) return other;
+        const size_t work = node->size + other->size;
+        Node* less = nullptr;
+        Node* greater = nullptr;
+        if (Node* dup = split(node, other->key, less, greater)) {
+            deallocate(dup);
+        }
+        Node* otherLess = other->left;
+        Node* otherGreater = other->right;
+        inParallel(
+            work,
+            [&] { less = unionNodes(less, otherLess); },
+            [&] { greater = unionNodes(greater, otherGreater); });
+        return join(less, other, greater);
+    }
+
+    Node* intersectNodes(Node* node, const Node* other) {
+        if (!node) return nullptr;
+        if (!other) {
+            destroyTree(node);
+            return nullptr;
+        }
+        const size_t work = node->size + other->size;
+        Node* less = nullptr;
+        Node* greater = nullptr;
+        Node* mid = split(node, other->key, less, greater);
+        inParallel(
+            work,
+            [&] { less = intersectNodes(less, other->left); },
+            [&] { greater = intersectNodes(greater, other->right); });
+        return mid ? join(less, mid, greater) : join2(less, greater);
+    }
+
+    Node* differenceNodes(Node* node, const Node* other) {
+        if (!node || !other) return node;
+        const size_t work = node->size + other->size;
+        Node* less = nullptr;
+        Node* greater = nullptr;
+        Node* mid = split(node, other->key, less, greater);
+        if (mid) {
+            deallocate(mid);
+        }
+        inParallel(
+            work,
+            [&] { less = differenceNodes(less, other->left); },
+            [&] { greater = differenceNodes(greater, other->right); });
+        return join2(less, greater);
+    }
+
+    template<typename Pred> Node* filterNodes(Node* node, Pred& pred) {
+        if (!node) return nullptr;
+        Node* less = node->left;
+        Node* greater = node->right;
+        inParallel(
+            node->size,
+            [&] { less = filterNodes(less, pred); },
+            [&] { greater = filterNodes(greater, pred); });
+        if (pred(static_cast<const Key&>(node->key),
+                 static_cast<const Value&>(node->value))) {
+            return join(less, node, greater);
+        }
+        deallocate(node);
+        return join2(less, greater);
+    }
+};
+
+// 把 other 的所有元素并入 map，键相同时取 other 的值。
+// 节点分配或值拷贝抛出异常时 map 保持原样
+template<typename Key, typename Value, typename Alloc>
+void union_with(
+    AVLMap<Key, Value, Alloc>& map, const AVLMap<Key, Value, Alloc>& other) {
+    if (&other == &map) return;
+    Ops<Key, Value, Alloc>(map).unionWith(other);
+}
+
+// 只保留 other 中也有的键，值不变
+template<typename Key, typename Value, typename Alloc>
+void intersect_with(
+    AVLMap<Key, Value, Alloc>& map, const AVLMap<Key, Value, Alloc>& other) {
+    if (&other == &map) return;
+    Ops<Key, Value, Alloc>(map).intersectWith(other);
+}
+
+// 删除 other 中也有的键
+template<typename Key, typename Value, typename Alloc>
+void difference(
+    AVLMap<Key, Value, Alloc>& map, const AVLMap<Key, Value, Alloc>& other) {
+    if (&other == &map) {
+        map.clear();
+        return;
+    }
+    Ops<Key, Value, Alloc>(map).difference(other);
+}
+
+// 只保留 pred(key, value) 为真的元素。pred 可能在多个线程中同时调用，
+// 不能抛出异常
+template<typename Key, typename Value, typename Alloc, typename Pred>
+void filter(AVLMap<Key, Value, Alloc>& map, Pred pred) {
+    Ops<Key, Value, Alloc>(map).filter(pred);
+}
+
+} // namespace avl_set
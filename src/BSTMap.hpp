@@ -1,27 +1,49 @@
 #pragma once
+#include "NodePool.hpp"
+#include "SortedInput.hpp"
+#include <algorithm>
 #include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 template<typename Key, typename T> struct TreeNode {
     std::pair<Key, T> data;
     TreeNode*         left;
     TreeNode*         right;
     TreeNode*         parent;
+    bool              red;   // 红黑树颜色，新节点为红色
 
 
     TreeNode(
         const Key& key, const T& value, TreeNode* parent = nullptr,
         TreeNode* left = nullptr, TreeNode* right = nullptr)
         : data(std::make_pair(key, value))
-        , left(nullptr)   // 正确初始化
-        , right(nullptr)
-        , parent(parent) {}
+        , left(left)
+        , right(right)
+        , parent(parent)
+        , red(true) {}
+
+    TreeNode(const TreeNode&)            = delete;
+    TreeNode& operator=(const TreeNode&) = delete;
 };
 
 
-template<typename Key, typename T> class Map {
+// 红黑树实现的有序映射，插入、查找、删除在最坏情况下都是 O(log n)。
+// 删除时重新链接节点而不是搬移数据，指向其他元素的迭代器不会失效。
+// Alloc 决定节点从哪里分配，默认来自连续的内存块，见 NodePool.hpp。
+template<typename Key, typename T, typename Alloc = ArenaNodes> class Map {
+    using Pool = typename Alloc::template Pool<TreeNode<Key, T>>;
+
 public:
-    Map() : root(nullptr) {}
-    ~Map() { clear(root); }
+    Map() : root(nullptr), nodes_() {}
+
+    // 从 (key, value) 序列建树，见 assign_sorted
+    template<typename It> Map(It first, It last) : Map() {
+        assign_sorted(first, last);
+    }
+
+    ~Map() { clear(); }
 
     // 禁止拷贝构造和赋值
     Map(const Map&)            = delete;
@@ -30,7 +52,8 @@ public:
     // 插入或更新键值对
     void insert(const Key& key, const T& value) {
         if (root == nullptr) {
-            root = new TreeNode<Key, T>(key, value);
+            root      = nodes_.create(key, value);
+            root->red = false;
             return;
         }
 
@@ -50,10 +73,26 @@ public:
             }
         }
 
+        TreeNode<Key, T>* node = nodes_.create(key, value, parent);
         if (key < parent->data.first) {
-            parent->left = new TreeNode<Key, T>(key, value, parent);
+            parent->left = node;
         } else {
-            parent->right = new TreeNode<Key, T>(key, value, parent);
+            parent->right = node;
+        }
+        insertFixup(node);
+    }
+
+    // 用 (key, value) 序列替换全部内容。键严格递增时直接 O(n) 建出
+    // 完全平衡的树，否则先拷贝、排序、去重（重复的键保留最后一个值）
+    template<typename It> void assign_sorted(It first, It last) {
+        clear();
+        if (sorted_input::usable_in_place(first, last)) {
+            size_t n = static_cast<size_t>(std::distance(first, last));
+            build(first, n);
+        } else {
+            auto items = sorted_input::sort_unique<Key, T>(first, last);
+            auto it    = items.cbegin();
+            build(it, items.size());
         }
     }
 
@@ -76,35 +115,51 @@ public:
         TreeNode<Key, T>* node = find(key);
         if (node == nullptr) return;
 
-        // Case 3: 节点有两个子节点
-        if (node->left && node->right) {
+        // x 顶替被移走的位置，可能为空，所以单独记录它的父节点
+        TreeNode<Key, T>* x          = nullptr;
+        TreeNode<Key, T>* xParent    = nullptr;
+        bool              removedRed = node->red;
+
+        if (node->left == nullptr) {
+            x       = node->right;
+            xParent = node->parent;
+            transplant(node, node->right);
+        } else if (node->right == nullptr) {
+            x       = node->left;
+            xParent = node->parent;
+            transplant(node, node->left);
+        } else {
+            // 有两个子节点：用后继节点接替 node 的位置和颜色
             TreeNode<Key, T>* successor = minimum(node->right);
-            node->data                  = successor->data;
-            node                        = successor;   // 将待删除节点转移到后继
-        }
-
-        // 处理子节点（此时node最多有一个子节点）
-        TreeNode<Key, T>* child = node->left ? node->left : node->right;
-
-        // 更新子节点的父指针
-        if (child) {
-            child->parent = node->parent;
+            removedRed                  = successor->red;
+            x                           = successor->right;
+            if (successor->parent == node) {
+                xParent = successor;
+            } else {
+                xParent = successor->parent;
+                transplant(successor, successor->right);
+                successor->right         = node->right;
+                successor->right->parent = successor;
+            }
+            transplant(node, successor);
+            successor->left         = node->left;
+            successor->left->parent = successor;
+            successor->red          = node->red;
         }
 
-        // 更新父节点的子指针
-        if (node->parent == nullptr) {
-            root = child;
-        } else if (node == node->parent->left) {
-            node->parent->left = child;
-        } else {
-            node->parent->right = child;
+        nodes_.destroy(node);
+        if (!removedRed) {
+            eraseFixup(x, xParent);
         }
-
-        delete node;
     }
-    // 清空所有节点
+    // 清空所有节点。节点无需析构且来自内存块时直接整块归还，不逐个访问
     void clear() {
-        clear(root);
+        if constexpr (!(Pool::bulk_release
+                        && std::is_trivially_destructible_v<
+                            TreeNode<Key, T>>)) {
+            destroyTree(root);
+        }
+        nodes_.release();
         root = nullptr;
     }
 
@@ -167,15 +222,262 @@ public:
 
     Iterator end() const { return Iterator(nullptr); }
 
+    // 第一个键不小于 key 的元素
+    Iterator lower_bound(const Key& key) const {
+        TreeNode<Key, T>* result  = nullptr;
+        TreeNode<Key, T>* current = root;
+        while (current != nullptr) {
+            if (current->data.first < key) {
+                current = current->right;
+            } else {
+                result  = current;
+                current = current->left;
+            }
+        }
+        return Iterator(result);
+    }
+
+    // 第一个键大于 key 的元素
+    Iterator upper_bound(const Key& key) const {
+        TreeNode<Key, T>* result  = nullptr;
+        TreeNode<Key, T>* current = root;
+        while (current != nullptr) {
+            if (key < current->data.first) {
+                result  = current;
+                current = current->left;
+            } else {
+                current = current->right;
+            }
+        }
+        return Iterator(result);
+    }
+
+    std::pair<Iterator, Iterator> equal_range(const Key& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // 一段迭代器区间，可以直接用于范围 for
+    struct Range {
+        Iterator first;
+        Iterator last;
+
+        Iterator begin() const { return first; }
+        Iterator end() const { return last; }
+    };
+
+    // 键在 [lo, hi) 内的元素，按顺序遍历，代价 O(log n + k)
+    Range range(const Key& lo, const Key& hi) const {
+        if (!(lo < hi)) {
+            return Range{end(), end()};
+        }
+        return Range{lower_bound(lo), lower_bound(hi)};
+    }
+
+    // 树高，空树为 0
+    size_t height() const {
+        using Entry = std::pair<TreeNode<Key, T>*, size_t>;
+        std::vector<Entry> stack;
+        size_t             best = 0;
+        if (root) stack.emplace_back(root, 1);
+        while (!stack.empty()) {
+            auto [node, depth] = stack.back();
+            stack.pop_back();
+            best = std::max(best, depth);
+            if (node->left) stack.emplace_back(node->left, depth + 1);
+            if (node->right) stack.emplace_back(node->right, depth + 1);
+        }
+        return best;
+    }
+
 private:
     TreeNode<Key, T>* root;
+    Pool              nodes_;
 
-    // 删除树中的所有节点
-    void clear(TreeNode<Key, T>* node) {
-        if (node == nullptr) return;
-        clear(node->left);
-        clear(node->right);
-        delete node;
+    static bool isRed(const TreeNode<Key, T>* node) {
+        return node != nullptr && node->red;
+    }
+
+    // 用 v 替换 u 在父节点中的位置
+    void transplant(TreeNode<Key, T>* u, TreeNode<Key, T>* v) {
+        if (u->parent == nullptr) {
+            root = v;
+        } else if (u == u->parent->left) {
+            u->parent->left = v;
+        } else {
+            u->parent->right = v;
+        }
+        if (v) {
+            v->parent = u->parent;
+        }
+    }
+
+    void rotateLeft(TreeNode<Key, T>* x) {
+        TreeNode<Key, T>* y = x->right;
+        x->right            = y->left;
+        if (y->left) {
+            y->left->parent = x;
+        }
+        transplant(x, y);
+        y->left   = x;
+        x->parent = y;
+    }
+
+    void rotateRight(TreeNode<Key, T>* x) {
+        TreeNode<Key, T>* y = x->left;
+        x->left             = y->right;
+        if (y->right) {
+            y->right->parent = x;
+        }
+        transplant(x, y);
+        y->right  = x;
+        x->parent = y;
+    }
+
+    // 新插入的红节点若有红色父节点，按叔节点颜色重新着色或旋转
+    void insertFixup(TreeNode<Key, T>* node) {
+        while (isRed(node->parent)) {
+            TreeNode<Key, T>* parent = node->parent;
+            TreeNode<Key, T>* grand  = parent->parent;
+            if (parent == grand->left) {
+                TreeNode<Key, T>* uncle = grand->right;
+                if (isRed(uncle)) {
+                    parent->red = uncle->red = false;
+                    grand->red               = true;
+                    node                     = grand;
+                    continue;
+                }
+                if (node == parent->right) {
+                    rotateLeft(parent);
+                    node   = parent;
+                    parent = node->parent;
+                }
+                parent->red = false;
+                grand->red  = true;
+                rotateRight(grand);
+            } else {
+                TreeNode<Key, T>* uncle = grand->left;
+                if (isRed(uncle)) {
+                    parent->red = uncle->red = false;
+                    grand->red               = true;
+                    node                     = grand;
+                    continue;
+                }
+                if (node == parent->left) {
+                    rotateRight(parent);
+                    node   = parent;
+                    parent = node->parent;
+                }
+                parent->red = false;
+                grand->red  = true;
+                rotateLeft(grand);
+            }
+        }
+        root->red = false;
+    }
+
+    // 删除黑节点后 x 所在路径少了一个黑节点，向上补齐
+    void eraseFixup(TreeNode<Key, T>* x, TreeNode<Key, T>* parent) {
+        while (x != root && !isRed(x)) {
+            if (x == parent->left) {
+                TreeNode<Key, T>* sibling = parent->right;
+                if (isRed(sibling)) {
+                    sibling->red = false;
+                    parent->red  = true;
+                    rotateLeft(parent);
+                    sibling = parent->right;
+                }
+                if (!isRed(sibling->left) && !isRed(sibling->right)) {
+                    sibling->red = true;
+                    x            = parent;
+                    parent       = x->parent;
+                    continue;
+                }
+                if (!isRed(sibling->right)) {
+                    sibling->left->red = false;
+                    sibling->red       = true;
+                    rotateRight(sibling);
+                    sibling = parent->right;
+                }
+                sibling->red        = parent->red;
+                parent->red         = false;
+                sibling->right->red = false;
+                rotateLeft(parent);
+            } else {
+                TreeNode<Key, T>* sibling = parent->left;
+                if (isRed(sibling)) {
+                    sibling->red = false;
+                    parent->red  = true;
+                    rotateRight(parent);
+                    sibling = parent->left;
+                }
+                if (!isRed(sibling->left) && !isRed(sibling->right)) {
+                    sibling->red = true;
+                    x            = parent;
+                    parent       = x->parent;
+                    continue;
+                }
+                if (!isRed(sibling->left)) {
+                    sibling->right->red = false;
+                    sibling->red        = true;
+                    rotateLeft(sibling);
+                    sibling = parent->left;
+                }
+                sibling->red       = parent->red;
+                parent->red        = false;
+                sibling->left->red = false;
+                rotateRight(parent);
+            }
+            x = root;
+        }
+        if (x) {
+            x->red = false;
+        }
+    }
+
+    // 按中点划分建树，除最深一层外都是满的。最深一层染红、其余染黑，
+    // 每条路径上的黑节点数相同；只有一层时根节点仍为黑色
+    template<typename It> void build(It& it, size_t n) {
+        size_t depth = 0;
+        while ((size_t(2) << depth) <= n) {
+            ++depth;
+        }
+        root = buildSubtree(it, n, 0, depth);
+        if (root) {
+            root->red = false;
+        }
+    }
+
+    // 按中序依次消耗输入，左子树先取走前一半
+    template<typename It>
+    TreeNode<Key, T>*
+    buildSubtree(It& it, size_t n, size_t depth, size_t redDepth) {
+        if (n == 0) return nullptr;
+        TreeNode<Key, T>* left =
+            buildSubtree(it, n / 2, depth + 1, redDepth);
+        TreeNode<Key, T>* node = nodes_.create(it->first, it->second);
+        ++it;
+        node->red   = depth == redDepth;
+        node->left  = left;
+        node->right = buildSubtree(it, n - n / 2 - 1, depth + 1, redDepth);
+        if (node->left) node->left->parent = node;
+        if (node->right) node->right->parent = node;
+        return node;
+    }
+
+    // 逐个删除节点：有左子树就右旋把它提上来，否则删除当前节点转向右子树。
+    // 不用递归也不用额外的栈，树再深也不会栈溢出
+    void destroyTree(TreeNode<Key, T>* node) {
+        while (node != nullptr) {
+            if (TreeNode<Key, T>* left = node->left) {
+                node->left  = left->right;
+                left->right = node;
+                node        = left;
+            } else {
+                TreeNode<Key, T>* right = node->right;
+                nodes_.destroy(node);
+                node = right;
+            }
+        }
     }
 
     // 找到最小的节点
@@ -1,123 +1,462 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
-template<typename T> struct BTreeNode {
-    std::vector<T>             keys;
-    std::vector<BTreeNode<T>*> children;
-    bool                       leaf;
+// B+ 树节点。内部节点只存分隔键和子节点，第 i 个子树中的键都在
+// [keys[i - 1], keys[i]) 内；键值对只存在叶子中，叶子按键的顺序双向链接
+template<typename Key, typename Value> struct BTreeNode {
+    std::vector<Key>         keys;
+    std::vector<Value>       values;     // 只有叶子使用
+    std::vector<BTreeNode*>  children;   // 只有内部节点使用
+    bool                     leaf;
+    BTreeNode*               prev;
+    BTreeNode*               next;
 
-    BTreeNode(bool leaf1) : leaf(leaf1) {}
+    explicit BTreeNode(bool leaf1)
+        : keys()
+        , values()
+        , children()
+        , leaf(leaf1)
+        , prev(nullptr)
+        , next(nullptr) {}
+    BTreeNode(const BTreeNode& other) = delete;
+    BTreeNode& operator=(const BTreeNode& other) = delete;
 };
 
 
-template<typename T> class BTree {
+// 最小度数为 t 时，除根以外每个节点有 t - 1 到 2t - 1 个键。
+// 插入时自顶向下预先分裂满节点，删除后自底向上向兄弟借键或与兄弟合并。
+// 修改会使所有迭代器失效
+template<typename Key, typename Value> class BTree {
+    using Node = BTreeNode<Key, Value>;
+
 public:
-    BTree(int degree) : root(nullptr), Minimum_degree(degree) {}
+    explicit BTree(size_t degree = 16)
+        : root(nullptr)
+        , head(nullptr)
+        , tail(nullptr)
+        , count(0)
+        , Minimum_degree(degree) {
+        if (degree < 2) {
+            throw std::runtime_error("BTree degree must be at least 2");
+        }
+    }
+
+    BTree(const BTree& other) = delete;
+    BTree& operator=(const BTree& other) = delete;
 
-    void insert(const T& key) {
+    ~BTree() { clear(); }
+
+    // 键已存在时覆盖它的值并返回 false
+    bool insert(const Key& key, const Value& value) {
         if (root == nullptr) {
-            root = new BTreeNode<T>(true);
-            root->keys.push_back(key);
-        } else {
-            if (root->keys.size() == 2 * Minimum_degree - 1) {
-                BTreeNode<T>* newRoot = new BTreeNode<T>(false);
-                newRoot->children.push_back(root);
-                splitChild(newRoot, 0, root);
-                root = newRoot;
+            std::unique_ptr<Node> leaf(new Node(true));
+            reserve(leaf.get());
+            root = head = tail = leaf.release();
+        } else if (isFull(root)) {
+            std::unique_ptr<Node> newRoot(new Node(false));
+            reserve(newRoot.get());
+            newRoot->children.push_back(root);
+            splitChild(newRoot.get(), 0);
+            root = newRoot.release();
+        }
+        Node* node = root;
+        while (!node->leaf) {
+            size_t i = childIndex(node, key);
+            if (isFull(node->children[i])) {
+                splitChild(node, i);
+                if (!(key < node->keys[i])) {
+                    i++;
+                }
+            }
+            node = node->children[i];
+        }
+        size_t i = lowerIndex(node, key);
+        if (i < node->keys.size() && !(key < node->keys[i])) {
+            node->values[i] = value;
+            return false;
+        }
+        node->keys.insert(node->keys.begin() + diff(i), key);
+        node->values.insert(node->values.begin() + diff(i), value);
+        count++;
+        return true;
+    }
+
+    Value* search(const Key& key) const {
+        if (root == nullptr) {
+            return nullptr;
+        }
+        Node*  node = findLeaf(key);
+        size_t i    = lowerIndex(node, key);
+        if (i < node->keys.size() && !(key < node->keys[i])) {
+            return &node->values[i];
+        }
+        return nullptr;
+    }
+
+    // 键不存在时返回 false
+    bool erase(const Key& key) {
+        if (root == nullptr || !eraseFrom(root, key)) {
+            return false;
+        }
+        count--;
+        if (root->keys.empty()) {
+            Node* old = root;
+            if (root->leaf) {
+                root = head = tail = nullptr;
+            } else {
+                root = root->children.front();
             }
-            insertNonFull(root, key);
+            delete old;
+        }
+        return true;
+    }
+
+    size_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        destroy(root);
+        root = head = tail = nullptr;
+        count = 0;
+    }
+
+    // 双向迭代器，指向叶子中的一个位置；end() 不指向任何叶子
+    class Iterator {
+    public:
+        Iterator() : tree(nullptr), node(nullptr), index(0) {}
+
+        const Key& key() const { return node->keys[index]; }
+
+        Value& value() const { return node->values[index]; }
+
+        std::pair<const Key&, Value&> operator*() const {
+            return {key(), value()};
+        }
+
+        // 叶子末尾转到下一个叶子
+        Iterator& operator++() {
+            if (++index == node->keys.size()) {
+                node  = node->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        // end() 退回到最后一个叶子
+        Iterator& operator--() {
+            if (node == nullptr) {
+                node  = tree->tail;
+                index = node->keys.size() - 1;
+            } else if (index == 0) {
+                node  = node->prev;
+                index = node->keys.size() - 1;
+            } else {
+                index--;
+            }
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator temp = *this;
+            --*this;
+            return temp;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return node == other.node && index == other.index;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class BTree;
+
+        Iterator(const BTree* tree1, Node* node1, size_t index1)
+            : tree(tree1), node(node1), index(index1) {}
+
+        const BTree* tree;
+        Node*        node;
+        size_t       index;
+    };
+
+    Iterator begin() const { return Iterator(this, head, 0); }
+
+    Iterator end() const { return Iterator(this, nullptr, 0); }
+
+    Iterator find(const Key& key) const {
+        Iterator it = lower_bound(key);
+        return it != end() && !(key < it.key()) ? it : end();
+    }
+
+    // 第一个键不小于 key 的元素
+    Iterator lower_bound(const Key& key) const {
+        if (root == nullptr) {
+            return end();
         }
+        Node* node = findLeaf(key);
+        return at(node, lowerIndex(node, key));
     }
 
+    // 第一个键大于 key 的元素
+    Iterator upper_bound(const Key& key) const {
+        if (root == nullptr) {
+            return end();
+        }
+        Node* node = findLeaf(key);
+        return at(node, childIndex(node, key));
+    }
 
-    BTreeNode<T>* search(const T& key) {
-        return (root == nullptr) ? nullptr : search(root, key);
+    // 一段迭代器区间，可以直接用于范围 for
+    struct Range {
+        Iterator first;
+        Iterator last;
+
+        Iterator begin() const { return first; }
+        Iterator end() const { return last; }
+    };
+
+    // 键在 [lo, hi) 内的元素，沿叶子链表顺序扫描，代价 O(log n + k)
+    Range range(const Key& lo, const Key& hi) const {
+        if (!(lo < hi)) {
+            return Range{end(), end()};
+        }
+        return Range{lower_bound(lo), lower_bound(hi)};
     }
 
-    void traverse() {
-        if (root != nullptr) {
-            traverse(root);
+    // 按顺序输出所有键
+    void traverse() const {
+        for (Node* node = head; node != nullptr; node = node->next) {
+            for (const Key& key : node->keys) {
+                std::cout << " " << key;
+            }
         }
         std::cout << std::endl;
     }
 
 private:
-    BTreeNode<T>* root;
-    int           Minimum_degree;
-    BTreeNode<T>* search(BTreeNode<T>* node, const T& key) {
-        int index = 0;
-        while (index < node->keys.size() && key > node->keys[index]) index++;
+    Node*  root;
+    Node*  head;    // 第一个叶子
+    Node*  tail;    // 最后一个叶子
+    size_t count;
+    size_t Minimum_degree;
 
-        if (index < node->keys.size() && key == node->keys[index]) {
-            return node;
-        }
+    static std::ptrdiff_t diff(size_t i) {
+        return static_cast<std::ptrdiff_t>(i);
+    }
 
+    bool isFull(const Node* node) const {
+        return node->keys.size() == 2 * Minimum_degree - 1;
+    }
+
+    // 节点的容量一次预留够，分裂和合并时不再重新分配
+    void reserve(Node* node) const {
+        node->keys.reserve(2 * Minimum_degree);
         if (node->leaf) {
-            return nullptr;
+            node->values.reserve(2 * Minimum_degree);
+        } else {
+            node->children.reserve(2 * Minimum_degree + 1);
         }
+    }
 
-        return search(node->children[index], key);
+    // key 所在的子树：分隔键等于 key 时在右边
+    static size_t childIndex(const Node* node, const Key& key) {
+        auto pos = std::upper_bound(node->keys.begin(), node->keys.end(), key);
+        return static_cast<size_t>(pos - node->keys.begin());
     }
 
-    void insertNonFull(BTreeNode<T>* node, const T& key) {
-        int i = node->keys.size() - 1;
-        if (node->leaf) {
-            node->keys.push_back(T());   // Make space for the new key
-            while (i >= 0 && key < node->keys[i]) {
-                node->keys[i + 1] = node->keys[i];
-                i--;
-            }
-            node->keys[i + 1] = key;
+    static size_t lowerIndex(const Node* node, const Key& key) {
+        auto pos = std::lower_bound(node->keys.begin(), node->keys.end(), key);
+        return static_cast<size_t>(pos - node->keys.begin());
+    }
+
+    Node* findLeaf(const Key& key) const {
+        Node* node = root;
+        while (!node->leaf) {
+            node = node->children[childIndex(node, key)];
+        }
+        return node;
+    }
+
+    // 叶子末尾的位置换成下一个叶子的开头
+    Iterator at(Node* node, size_t index) const {
+        if (index == node->keys.size()) {
+            return Iterator(this, node->next, 0);
+        }
+        return Iterator(this, node, index);
+    }
+
+    // 把满的 children[index] 分成两半，右半放到它后面。
+    // 叶子把右半的第一个键复制到父节点；内部节点把中间的键移到父节点。
+    // 可能抛出异常的拷贝都在改动 child 之前完成，right 挂到父节点前由
+    // unique_ptr 持有；截断用 erase，不要求键和值可以默认构造
+    void splitChild(Node* parent, size_t index) {
+        Node*                 child = parent->children[index];
+        std::unique_ptr<Node> right(new Node(child->leaf));
+        const size_t          t = Minimum_degree;
+        reserve(right.get());
+
+        auto keyPos = parent->keys.begin() + diff(index);
+        if (child->leaf) {
+            right->keys.assign(
+                child->keys.begin() + diff(t), child->keys.end());
+            right->values.assign(
+                child->values.begin() + diff(t), child->values.end());
+            parent->keys.insert(keyPos, right->keys.front());
         } else {
-            while (i >= 0 && key < node->keys[i]) {
-                i--;
-            }
-            i++;
-            if (node->children[i]->keys.size() == 2 * Minimum_degree - 1) {
-                splitChild(node, i, node->children[i]);
-                if (key > node->keys[i]) {
-                    i++;
-                }
+            right->keys.assign(
+                child->keys.begin() + diff(t), child->keys.end());
+            right->children.assign(
+                child->children.begin() + diff(t), child->children.end());
+            parent->keys.insert(keyPos, std::move(child->keys[t - 1]));
+        }
+        parent->children.insert(
+            parent->children.begin() + diff(index) + 1, right.get());
+        Node* split = right.release();
+
+        if (child->leaf) {
+            child->keys.erase(child->keys.begin() + diff(t), child->keys.end());
+            child->values.erase(
+                child->values.begin() + diff(t), child->values.end());
+            split->prev = child;
+            split->next = child->next;
+            if (child->next != nullptr) {
+                child->next->prev = split;
+            } else {
+                tail = split;
             }
-            insertNonFull(node->children[i], key);
+            child->next = split;
+        } else {
+            child->keys.erase(
+                child->keys.begin() + diff(t - 1), child->keys.end());
+            child->children.erase(
+                child->children.begin() + diff(t), child->children.end());
         }
     }
-    void splitChild(BTreeNode<T>* parent, int index, BTreeNode<T>* child) {
-        BTreeNode<T>* newNode = new BTreeNode<T>(child->leaf);
-        newNode->keys.resize(Minimum_degree - 1);
-        child->keys.resize(Minimum_degree - 1);
 
-        for (int i = 0; i < Minimum_degree - 1; i++) {
-            newNode->keys[i] = child->keys[i + Minimum_degree];
+    // 删除后子节点的键少于 t - 1 个时由父节点修复，根节点除外
+    bool eraseFrom(Node* node, const Key& key) {
+        if (node->leaf) {
+            size_t i = lowerIndex(node, key);
+            if (i == node->keys.size() || key < node->keys[i]) {
+                return false;
+            }
+            node->keys.erase(node->keys.begin() + diff(i));
+            node->values.erase(node->values.begin() + diff(i));
+            return true;
+        }
+        size_t i = childIndex(node, key);
+        if (!eraseFrom(node->children[i], key)) {
+            return false;
+        }
+        if (node->children[i]->keys.size() < Minimum_degree - 1) {
+            fixChild(node, i);
         }
+        return true;
+    }
 
-        if (!child->leaf) {
-            newNode->children.resize(Minimum_degree);
-            for (int i = 0; i < Minimum_degree - 1; i++) {
-                newNode->keys[i] = child->keys[i + Minimum_degree];
-            }
+    // 兄弟节点有富余时借一个键，否则与兄弟合并
+    void fixChild(Node* parent, size_t index) {
+        if (index > 0
+            && parent->children[index - 1]->keys.size() >= Minimum_degree) {
+            borrowFromLeft(parent, index);
+        } else if (index + 1 < parent->children.size()
+                   && parent->children[index + 1]->keys.size()
+                          >= Minimum_degree) {
+            borrowFromRight(parent, index);
+        } else if (index > 0) {
+            merge(parent, index - 1);
+        } else {
+            merge(parent, index);
+        }
+    }
 
-            child->children.resize(Minimum_degree);
+    void borrowFromLeft(Node* parent, size_t index) {
+        Node* child = parent->children[index];
+        Node* left  = parent->children[index - 1];
+        if (child->leaf) {
+            child->keys.insert(child->keys.begin(), left->keys.back());
+            child->values.insert(child->values.begin(), left->values.back());
+            left->keys.pop_back();
+            left->values.pop_back();
+            parent->keys[index - 1] = child->keys.front();
+        } else {
+            child->keys.insert(child->keys.begin(), parent->keys[index - 1]);
+            child->children.insert(
+                child->children.begin(), left->children.back());
+            parent->keys[index - 1] = left->keys.back();
+            left->keys.pop_back();
+            left->children.pop_back();
         }
+    }
 
-        parent->children.insert(parent->children.begin() + index + 1, newNode);
-        parent->keys.insert(
-            parent->keys.begin() + index, child->keys[Minimum_degree - 1]);
+    void borrowFromRight(Node* parent, size_t index) {
+        Node* child = parent->children[index];
+        Node* right = parent->children[index + 1];
+        if (child->leaf) {
+            child->keys.push_back(right->keys.front());
+            child->values.push_back(right->values.front());
+            right->keys.erase(right->keys.begin());
+            right->values.erase(right->values.begin());
+            parent->keys[index] = right->keys.front();
+        } else {
+            child->keys.push_back(parent->keys[index]);
+            child->children.push_back(right->children.front());
+            parent->keys[index] = right->keys.front();
+            right->keys.erase(right->keys.begin());
+            right->children.erase(right->children.begin());
+        }
     }
 
-    void traverse(BTreeNode<T>* node) {
-        int i = 0;
-        for (i = 0; i < node->keys.size(); i++) {
-            if (!node->leaf) {
-                traverse(node->children[i]);
+    // 把 children[index + 1] 并入 children[index]，删掉两者之间的分隔键
+    void merge(Node* parent, size_t index) {
+        Node* left  = parent->children[index];
+        Node* right = parent->children[index + 1];
+        if (left->leaf) {
+            left->keys.insert(
+                left->keys.end(), right->keys.begin(), right->keys.end());
+            left->values.insert(
+                left->values.end(), right->values.begin(), right->values.end());
+            left->next = right->next;
+            if (right->next != nullptr) {
+                right->next->prev = left;
+            } else {
+                tail = left;
             }
-            std::cout << " " << node->keys[i];
+        } else {
+            left->keys.push_back(parent->keys[index]);
+            left->keys.insert(
+                left->keys.end(), right->keys.begin(), right->keys.end());
+            left->children.insert(left->children.end(),
+                                  right->children.begin(),
+                                  right->children.end());
         }
+        parent->keys.erase(parent->keys.begin() + diff(index));
+        parent->children.erase(parent->children.begin() + diff(index) + 1);
+        delete right;
+    }
 
-        if (!node->leaf) {
-            traverse(node->children[i]);
+    void destroy(Node* node) {
+        if (node == nullptr) {
+            return;
+        }
+        for (Node* child : node->children) {
+            destroy(child);
         }
+        delete node;
     }
 };
@@ -0,0 +1,369 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace compact_avl {
+
+// 节点只存查找路径上要读的东西：键和两个 32 位下标。
+// left 的高 2 位存平衡因子（左高减右高）加 1，剩下 30 位是下标
+template<typename Key, typename Value, bool SplitValues> struct Node {
+    Key      key;
+    uint32_t left;
+    uint32_t right;
+};
+
+// 值跟节点放在一起，放在最后，不影响前面字段的偏移
+template<typename Key, typename Value> struct Node<Key, Value, false> {
+    Key      key;
+    uint32_t left;
+    uint32_t right;
+    Value    value;
+};
+
+} // namespace compact_avl
+
+// 紧凑布局的 AVL 树：节点连续存放在一个数组里，子节点用 32 位下标表示，
+// 平衡因子只占 2 位。SplitValues 为 true 时值放在另一个数组里，
+// 查找只经过键，每个缓存行能装下更多节点。
+// 删除时把数组末尾的节点挪到空出的位置，数组始终是稠密的；
+// 所以下标和值的地址在修改后都可能改变，get 返回的指针只在下次修改前有效。
+// 最多存放 2^30 - 1 个元素
+template<typename Key, typename Value, bool SplitValues = true>
+class CompactAVLMap {
+    using Node = compact_avl::Node<Key, Value, SplitValues>;
+
+    static constexpr uint32_t index_bits = 30;
+    static constexpr uint32_t index_mask = (1u << index_bits) - 1;
+    static constexpr uint32_t nil        = index_mask;
+
+public:
+    static constexpr size_t node_bytes = sizeof(Node);
+
+    CompactAVLMap() : nodes_(), values_(), root_(nil) {}
+
+    void put(const Key& key, const Value& value) {
+        bool grew = false;
+        root_ = insertNode(root_, key, value, grew);
+    }
+
+    const Value* get(const Key& key) const {
+        uint32_t i = find(key);
+        return i == nil ? nullptr : &valueAt(i);
+    }
+
+    Value* get(const Key& key) {
+        uint32_t i = find(key);
+        return i == nil ? nullptr : &valueAt(i);
+    }
+
+    void remove(const Key& key) {
+        uint32_t i = find(key);
+        if (i == nil) return;
+        bool shrank = false;
+        root_ = deleteNode(root_, key, shrank);
+        fillHole(i);
+    }
+
+    size_t size() const { return nodes_.size(); }
+
+    bool empty() const { return nodes_.empty(); }
+
+    void clear() {
+        nodes_.clear();
+        values_.clear();
+        root_ = nil;
+    }
+
+    void reserve(size_t n) {
+        nodes_.reserve(n);
+        if constexpr (SplitValues) {
+            values_.reserve(n);
+        }
+    }
+
+    // 节点和值数组占用的字节数，包括预留未用的部分
+    size_t memory_usage() const {
+        return nodes_.capacity() * sizeof(Node)
+             + values_.capacity() * sizeof(Value);
+    }
+
+    std::vector<std::pair<Key, Value>> inorder() const {
+        std::vector<std::pair<Key, Value>> res;
+        res.reserve(size());
+        // 没有父指针，用栈保存尚未访问的祖先
+        std::vector<uint32_t> stack;
+        uint32_t              i = root_;
+        while (i != nil || !stack.empty()) {
+            for (; i != nil; i = left(i)) {
+                stack.push_back(i);
+            }
+            i = stack.back();
+            stack.pop_back();
+            res.emplace_back(nodes_[i].key, valueAt(i));
+            i = nodes_[i].right;
+        }
+        return res;
+    }
+
+private:
+    std::vector<Node>  nodes_;
+    std::vector<Value> values_;   // SplitValues 为 false 时不使用
+    uint32_t           root_;
+
+    const Value& valueAt(uint32_t i) const {
+        if constexpr (SplitValues) {
+            return values_[i];
+        } else {
+            return nodes_[i].value;
+        }
+    }
+
+    Value& valueAt(uint32_t i) {
+        if constexpr (SplitValues) {
+            return values_[i];
+        } else {
+            return nodes_[i].value;
+        }
+    }
+
+    uint32_t find(const Key& key) const {
+        uint32_t i = root_;
+        while (i != nil) {
+            const Node& node = nodes_[i];
+            if (key < node.key) {
+                i = node.left & index_mask;
+            } else if (node.key < key) {
+                i = node.right;
+            } else {
+                return i;
+            }
+        }
+        return nil;
+    }
+
+    uint32_t left(uint32_t i) const { return nodes_[i].left & index_mask; }
+
+    uint32_t right(uint32_t i) const { return nodes_[i].right; }
+
+    int balance(uint32_t i) const {
+        return static_cast<int>(nodes_[i].left >> index_bits) - 1;
+    }
+
+    void setLeft(uint32_t i, uint32_t child) {
+        nodes_[i].left = (nodes_[i].left & ~index_mask) | child;
+    }
+
+    void setRight(uint32_t i, uint32_t child) { nodes_[i].right = child; }
+
+    void setBalance(uint32_t i, int b) {
+        nodes_[i].left = (static_cast<uint32_t>(b + 1) << index_bits)
+                       | (nodes_[i].left & index_mask);
+    }
+
+    // 新节点追加在数组末尾，平衡因子为 0
+    uint32_t allocate(const Key& key, const Value& value) {
+        if (nodes_.size() >= nil) {
+            throw std::runtime_error("CompactAVLMap is full");
+        }
+        const uint32_t i    = static_cast<uint32_t>(nodes_.size());
+        const uint32_t link = (1u << index_bits) | nil;
+        if constexpr (SplitValues) {
+            values_.push_back(value);
+            try {
+                nodes_.push_back(Node{key, link, nil});
+            } catch (...) {
+                values_.pop_back();
+                throw;
+            }
+        } else {
+            nodes_.push_back(Node{key, link, nil, value});
+        }
+        return i;
+    }
+
+    // 删除后 hole 处的节点已经不在树上，把末尾的节点挪过来并修改指向它的链接
+    void fillHole(uint32_t hole) {
+        const uint32_t last = static_cast<uint32_t>(nodes_.size() - 1);
+        if (hole != last) {
+            const Key& key = nodes_[last].key;
+            if (root_ == last) {
+                root_ = hole;
+            } else {
+                uint32_t parent = root_;
+                for (;;) {
+                    uint32_t next =
+                        key < nodes_[parent].key ? left(parent) : right(parent);
+                    if (next == last) break;
+                    parent = next;
+                }
+                if (key < nodes_[parent].key) {
+                    setLeft(parent, hole);
+                } else {
+                    setRight(parent, hole);
+                }
+            }
+            nodes_[hole] = std::move(nodes_[last]);
+            if constexpr (SplitValues) {
+                values_[hole] = std::move(values_[last]);
+            }
+        }
+        nodes_.pop_back();
+        if constexpr (SplitValues) {
+            values_.pop_back();
+        }
+    }
+
+    // i 的左子树比右子树高 2，旋转后返回新的子树根。
+    // 旋转后整棵子树变矮时 shorter 为 true，插入引起的失衡总是如此
+    uint32_t fixLeftHeavy(uint32_t i, bool& shorter) {
+        const uint32_t l  = left(i);
+        const int      lb = balance(l);
+        if (lb >= 0) {
+            setLeft(i, right(l));
+            setRight(l, i);
+            setBalance(i, lb == 0 ? 1 : 0);
+            setBalance(l, lb == 0 ? -1 : 0);
+            shorter = lb != 0;
+            return l;
+        }
+        const uint32_t lr = right(l);
+        const int      b  = balance(lr);
+        setRight(l, left(lr));
+        setLeft(i, right(lr));
+        setLeft(lr, l);
+        setRight(lr, i);
+        setBalance(i, b == 1 ? -1 : 0);
+        setBalance(l, b == -1 ? 1 : 0);
+        setBalance(lr, 0);
+        shorter = true;
+        return lr;
+    }
+
+    uint32_t fixRightHeavy(uint32_t i, bool& shorter) {
+        const uint32_t r  = right(i);
+        const int      rb = balance(r);
+        if (rb <= 0) {
+            setRight(i, left(r));
+            setLeft(r, i);
+            setBalance(i, rb == 0 ? -1 : 0);
+            setBalance(r, rb == 0 ? 1 : 0);
+            shorter = rb != 0;
+            return r;
+        }
+        const uint32_t rl = left(r);
+        const int      b  = balance(rl);
+        setLeft(r, right(rl));
+        setRight(i, left(rl));
+        setRight(rl, r);
+        setLeft(rl, i);
+        setBalance(i, b == -1 ? 1 : 0);
+        setBalance(r, b == 1 ? -1 : 0);
+        setBalance(rl, 0);
+        shorter = true;
+        return rl;
+    }
+
+    // 子树长高或变矮后调整 i 的平衡因子，需要时旋转。
+    // 返回新的子树根，grew / shrank 更新为以 i 为根的子树高度是否仍有变化
+    uint32_t leftGrew(uint32_t i, bool& grew) {
+        const int b = balance(i);
+        if (b < 1) {
+            setBalance(i, b + 1);
+            grew = b == 0;
+            return i;
+        }
+        uint32_t root = fixLeftHeavy(i, grew);
+        grew          = false;
+        return root;
+    }
+
+    uint32_t rightGrew(uint32_t i, bool& grew) {
+        const int b = balance(i);
+        if (b > -1) {
+            setBalance(i, b - 1);
+            grew = b == 0;
+            return i;
+        }
+        uint32_t root = fixRightHeavy(i, grew);
+        grew          = false;
+        return root;
+    }
+
+    uint32_t leftShrank(uint32_t i, bool& shrank) {
+        const int b = balance(i);
+        if (b > -1) {
+            setBalance(i, b - 1);
+            shrank = b == 1;
+            return i;
+        }
+        return fixRightHeavy(i, shrank);
+    }
+
+    uint32_t rightShrank(uint32_t i, bool& shrank) {
+        const int b = balance(i);
+        if (b < 1) {
+            setBalance(i, b + 1);
+            shrank = b == -1;
+            return i;
+        }
+        return fixLeftHeavy(i, shrank);
+    }
+
+    // 数组可能扩容，递归返回前不能持有节点的引用
+    uint32_t insertNode(
+        uint32_t i, const Key& key, const Value& value, bool& grew) {
+        if (i == nil) {
+            grew = true;
+            return allocate(key, value);
+        }
+        if (key < nodes_[i].key) {
+            uint32_t child = insertNode(left(i), key, value, grew);
+            setLeft(i, child);
+            return grew ? leftGrew(i, grew) : i;
+        }
+        if (nodes_[i].key < key) {
+            uint32_t child = insertNode(right(i), key, value, grew);
+            setRight(i, child);
+            return grew ? rightGrew(i, grew) : i;
+        }
+        valueAt(i) = value;
+        grew       = false;
+        return i;
+    }
+
+    // 摘下最小的节点放进 min
+    uint32_t removeMin(uint32_t i, uint32_t& min, bool& shrank) {
+        if (left(i) == nil) {
+            min    = i;
+            shrank = true;
+            return right(i);
+        }
+        setLeft(i, removeMin(left(i), min, shrank));
+        return shrank ? leftShrank(i, shrank) : i;
+    }
+
+    // 调用方保证 key 存在。有两个子节点时用后继节点接替，不拷贝键值
+    uint32_t deleteNode(uint32_t i, const Key& key, bool& shrank) {
+        if (key < nodes_[i].key) {
+            setLeft(i, deleteNode(left(i), key, shrank));
+            return shrank ? leftShrank(i, shrank) : i;
+        }
+        if (nodes_[i].key < key) {
+            setRight(i, deleteNode(right(i), key, shrank));
+            return shrank ? rightShrank(i, shrank) : i;
+        }
+        if (left(i) == nil || right(i) == nil) {
+            shrank = true;
+            return left(i) == nil ? right(i) : left(i);
+        }
+        uint32_t succ = nil;
+        uint32_t rest = removeMin(right(i), succ, shrank);
+        setLeft(succ, left(i));
+        setRight(succ, rest);
+        setBalance(succ, balance(i));
+        return shrank ? rightShrank(succ, shrank) : succ;
+    }
+};
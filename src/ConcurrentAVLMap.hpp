@@ -0,0 +1,841 @@
+#pragma once
+
+#include "EpochReclaim.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 并发有序映射，适合读多写少。做法参照 Bronson 等人的
+// "A Practical Concurrent Binary Search Tree"（PPoPP 2010）：
+//   - 读者不加锁，沿路径逐层记下节点的版本号，走到子节点后再确认父节点的
+//     版本未变（乐观的逐层验证）。旋转会让节点的键范围缩小，旋转前后改版本号，
+//     读者发现后退回上一层重试；
+//   - 写者只锁住要修改的节点，旋转时锁住父节点、节点和子节点，
+//     加锁总是从祖先到后代，不会死锁；
+//   - 删除有两个子节点的节点时只清空它的值，留作路由节点，
+//     等它不足两个子节点时再摘除；
+//   - 平衡条件与 AVLMap 相同，但允许其他线程修改期间暂时失衡，
+//     造成失衡的线程负责沿途修复。
+// 摘下的节点和被替换的值用纪元回收延迟释放，见 EpochReclaim.hpp。
+// 所有原子操作都用默认的 seq_cst，与论文中 Java volatile 的语义一致。
+template<typename Key, typename Value> class ConcurrentAVLMap {
+    // 值放在不可变的盒子里，整体替换，读者拿到指针后可以放心拷贝
+    struct Box {
+        explicit Box(const Value &v) : value(v) {}
+        const Value value;
+    };
+
+    // 短暂持有的自旋锁，等待过久时让出 CPU
+    class SpinLock {
+    public:
+        SpinLock() : locked_(false) {}
+
+        void lock() {
+            for (int spins = 0;; ++spins) {
+                if (!locked_.load(std::memory_order_relaxed)
+                    && !locked_.exchange(true, std::memory_order_acquire)) {
+                    return;
+                }
+                if (spins >= spin_limit) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void unlock() { locked_.store(false, std::memory_order_release); }
+
+    private:
+        std::atomic<bool> locked_;
+    };
+
+    struct Node;
+
+    // 树中所有节点和根的占位节点共有的部分
+    struct Link {
+        Link() : height(0), version(0), left(nullptr), right(nullptr), lock() {}
+
+        std::atomic<Node *> &child(bool to_right) {
+            return to_right ? right : left;
+        }
+
+        std::atomic<int>      height;
+        std::atomic<uint64_t> version;
+        std::atomic<Node *>   left;
+        std::atomic<Node *>   right;
+        SpinLock              lock;
+    };
+
+    struct Node : Link {
+        Node(const Key &key, Box *box, Link *parent)
+            : Link(), key(key), value(box), parent(parent) {
+            this->height.store(1);
+        }
+
+        const Key           key;
+        std::atomic<Box *>  value;   // 为空表示路由节点或已摘除
+        std::atomic<Link *> parent;
+    };
+
+    // 版本号：最低位表示已摘除，次低位表示正在缩小，其余位计数
+    static constexpr uint64_t unlinked  = 1;
+    static constexpr uint64_t shrinking = 2;
+
+    static constexpr int spin_limit = 64;
+
+    // node_condition 的返回值，非负时为应有的高度
+    static constexpr int unlink_required    = -1;
+    static constexpr int rebalance_required = -2;
+    static constexpr int nothing_required   = -3;
+
+public:
+    ConcurrentAVLMap() : holder_() {}
+
+    ConcurrentAVLMap(const ConcurrentAVLMap &)            = delete;
+    ConcurrentAVLMap &operator=(const ConcurrentAVLMap &) = delete;
+
+    // 析构时不能再有其他线程访问
+    ~ConcurrentAVLMap() {
+        std::vector<Node *> stack;
+        if (Node *root = holder_.right.load()) {
+            stack.push_back(root);
+        }
+        while (!stack.empty()) {
+            Node *node = stack.back();
+            stack.pop_back();
+            if (Node *left = node->left.load()) stack.push_back(left);
+            if (Node *right = node->right.load()) stack.push_back(right);
+            delete node->value.load();
+            delete node;
+        }
+    }
+
+    // 找到时把值拷贝到 out
+    bool get(const Key &key, Value &out) const {
+        epoch::Guard guard;
+        if (Box *box = find(key)) {
+            out = box->value;
+            return true;
+        }
+        return false;
+    }
+
+    bool contains(const Key &key) const {
+        epoch::Guard guard;
+        return find(key) != nullptr;
+    }
+
+    // 跳过只剩路由作用、没有值的节点
+    bool empty() const {
+        epoch::Guard guard;
+        for (Node *node = ceiling(nullptr, false); node;
+             node = ceiling(&node->key, true)) {
+            if (node->value.load()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 插入或更新键值对
+    void put(const Key &key, const Value &value) {
+        epoch::Guard         guard;
+        std::unique_ptr<Box> box(new Box(value));
+        Box                 *prev = update(key, box.get());
+        box.release();
+        if (prev) {
+            epoch::retire(prev);
+        }
+    }
+
+    // 键存在时删除并返回 true
+    bool remove(const Key &key) {
+        epoch::Guard guard;
+        Box         *prev = update(key, nullptr);
+        if (!prev) {
+            return false;
+        }
+        epoch::retire(prev);
+        return true;
+    }
+
+    // 按顺序取出键在 [lo, hi) 内的元素。每一步都是一次乐观的后继查找，
+    // 整个遍历期间一直存在的键一定会取到，期间插入或删除的键可能取到也可能取不到
+    std::vector<std::pair<Key, Value>>
+    range(const Key &lo, const Key &hi) const {
+        std::vector<std::pair<Key, Value>> out;
+        if (!(lo < hi)) {
+            return out;
+        }
+        epoch::Guard guard;
+        for (Node *node = ceiling(&lo, false); node && node->key < hi;
+             node = ceiling(&node->key, true)) {
+            if (Box *box = node->value.load()) {
+                out.emplace_back(node->key, box->value);
+            }
+        }
+        return out;
+    }
+
+private:
+    static bool equal(const Key &a, const Key &b) {
+        return !(a < b) && !(b < a);
+    }
+
+    static bool shrinking_or_unlinked(uint64_t version) {
+        return (version & (unlinked | shrinking)) != 0;
+    }
+
+    static uint64_t begin_change(uint64_t version) {
+        return version | shrinking;
+    }
+
+    // 清掉缩小标记，同时计数加一
+    static uint64_t end_change(uint64_t version) {
+        return (version | shrinking) + shrinking;
+    }
+
+    static int height(Node *node) { return node ? node->height.load() : 0; }
+
+    // 节点正在旋转时等它结束。旋转期间一直持有节点的锁
+    static void wait_until_not_changing(Node *node, uint64_t version) {
+        if (!(version & shrinking)) {
+            return;
+        }
+        for (int i = 0; i < spin_limit; ++i) {
+            if (node->version.load() != version) {
+                return;
+            }
+        }
+        std::lock_guard<SpinLock> lock(node->lock);
+    }
+
+    // ---------------- 查找 ----------------
+
+    Box *find(const Key &key) const {
+        for (;;) {
+            Node *root = holder_.right.load();
+            if (!root) {
+                return nullptr;
+            }
+            if (equal(key, root->key)) {
+                return root->value.load();
+            }
+            const uint64_t version = root->version.load();
+            if (shrinking_or_unlinked(version)) {
+                wait_until_not_changing(root, version);
+            } else if (root == holder_.right.load()) {
+                Box *found = nullptr;
+                if (attempt_get(
+                        key, root, root->key < key, version, found)) {
+                    return found;
+                }
+            }
+        }
+    }
+
+    // 在 node 的 to_right 一侧继续查找。返回 false 表示 node 在此期间
+    // 被旋转或摘除，到达 node 的路径可能已失效，需要回到上一层重试
+    static bool attempt_get(
+        const Key &key, Node *node, bool to_right, uint64_t node_version,
+        Box *&found) {
+        for (;;) {
+            Node *child = node->child(to_right).load();
+            if (node->version.load() != node_version) {
+                return false;
+            }
+            if (!child) {
+                found = nullptr;
+                return true;
+            }
+            if (equal(key, child->key)) {
+                found = child->value.load();
+                return true;
+            }
+            const uint64_t child_version = child->version.load();
+            if (shrinking_or_unlinked(child_version)) {
+                wait_until_not_changing(child, child_version);
+            } else if (child == node->child(to_right).load()) {
+                if (node->version.load() != node_version) {
+                    return false;
+                }
+                if (attempt_get(
+                        key, child, child->key < key, child_version, found)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    // 键不小于 *key（strict 时大于 *key）的最小节点，key 为空时取最小节点。
+    // 路径上任何一步验证失败都从根重新开始
+    Node *ceiling(const Key *key, bool strict) const {
+        for (;;) {
+            Node *node = holder_.right.load();
+            if (!node) {
+                return nullptr;
+            }
+            uint64_t version = node->version.load();
+            if (shrinking_or_unlinked(version)) {
+                wait_until_not_changing(node, version);
+                continue;
+            }
+            if (node != holder_.right.load()) {
+                continue;
+            }
+            Node *best  = nullptr;
+            bool  valid = true;
+            for (;;) {
+                const bool to_left = !key
+                                  || (strict ? *key < node->key
+                                             : !(node->key < *key));
+                if (to_left) {
+                    best = node;
+                    if (key && !strict && equal(*key, node->key)) {
+                        break;
+                    }
+                }
+                Node *child = node->child(!to_left).load();
+                if (node->version.load() != version) {
+                    valid = false;
+                    break;
+                }
+                if (!child) {
+                    break;
+                }
+                const uint64_t child_version = child->version.load();
+                if (shrinking_or_unlinked(child_version)) {
+                    wait_until_not_changing(child, child_version);
+                    valid = false;
+                    break;
+                }
+                if (child != node->child(!to_left).load()
+                    || node->version.load() != version) {
+                    valid = false;
+                    break;
+                }
+                node    = child;
+                version = child_version;
+            }
+            if (valid) {
+                return best;
+            }
+        }
+    }
+
+    // ---------------- 插入和删除 ----------------
+
+    // box 为空表示删除。返回原来的值，键不存在时为空
+    Box *update(const Key &key, Box *box) {
+        for (;;) {
+            Node *root = holder_.right.load();
+            if (!root) {
+                if (!box || attempt_insert_into_empty(key, box)) {
+                    return nullptr;
+                }
+                continue;
+            }
+            const uint64_t version = root->version.load();
+            if (shrinking_or_unlinked(version)) {
+                wait_until_not_changing(root, version);
+            } else if (root == holder_.right.load()) {
+                Box *prev = nullptr;
+                if (attempt_update(key, box, &holder_, root, version, prev)) {
+                    return prev;
+                }
+            }
+        }
+    }
+
+    bool attempt_insert_into_empty(const Key &key, Box *box) {
+        std::lock_guard<SpinLock> lock(holder_.lock);
+        if (holder_.right.load()) {
+            return false;
+        }
+        holder_.right.store(new Node(key, box, &holder_));
+        return true;
+    }
+
+    // 与 attempt_get 相同的逐层验证，走到空位置时锁住 node 插入新叶子
+    bool attempt_update(
+        const Key &key, Box *box, Link *parent, Node *node,
+        uint64_t node_version, Box *&prev) {
+        if (equal(key, node->key)) {
+            return attempt_node_update(box, parent, node, prev);
+        }
+        const bool to_right = node->key < key;
+        for (;;) {
+            Node *child = node->child(to_right).load();
+            if (node->version.load() != node_version) {
+                return false;
+            }
+            if (!child) {
+                if (!box) {
+                    prev = nullptr;
+                    return true;
+                }
+                Node *damaged  = nullptr;
+                bool  inserted = false;
+                {
+                    std::lock_guard<SpinLock> lock(node->lock);
+                    if (node->version.load() != node_version) {
+                        return false;
+                    }
+                    // 否则输给了并发的插入，在本层重试
+                    if (!node->child(to_right).load()) {
+                        node->child(to_right).store(new Node(key, box, node));
+                        inserted = true;
+                        damaged  = fix_height_nl(node);
+                    }
+                }
+                if (inserted) {
+                    fix_height_and_rebalance(damaged);
+                    prev = nullptr;
+                    return true;
+                }
+                continue;
+            }
+            const uint64_t child_version = child->version.load();
+            if (shrinking_or_unlinked(child_version)) {
+                wait_until_not_changing(child, child_version);
+            } else if (child == node->child(to_right).load()) {
+                if (node->version.load() != node_version) {
+                    return false;
+                }
+                if (attempt_update(
+                        key, box, node, child, child_version, prev)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    // 修改已有的节点。删除时若节点不足两个子节点就直接摘除，
+    // 这需要先锁父节点再锁节点；其余情况只锁节点本身
+    bool attempt_node_update(Box *box, Link *parent, Node *node, Box *&prev) {
+        if (!box && !node->value.load()) {
+            prev = nullptr;
+            return true;
+        }
+        if (!box && (!node->left.load() || !node->right.load())) {
+            Node *damaged = nullptr;
+            {
+                std::lock_guard<SpinLock> parent_lock(parent->lock);
+                if (parent->version.load() == unlinked
+                    || node->parent.load() != parent) {
+                    return false;
+                }
+                {
+                    std::lock_guard<SpinLock> node_lock(node->lock);
+                    prev = node->value.load();
+                    if (!prev) {
+                        return true;
+                    }
+                    if (!attempt_unlink_nl(parent, node)) {
+                        return false;
+                    }
+                }
+                damaged = fix_height_nl(parent);
+            }
+            fix_height_and_rebalance(damaged);
+            return true;
+        }
+        std::lock_guard<SpinLock> lock(node->lock);
+        if (node->version.load() == unlinked) {
+            return false;
+        }
+        prev = node->value.load();
+        if (!box) {
+            if (!prev) {
+                return true;
+            }
+            // 加锁前子节点少了一个，改走摘除的路径
+            if (!node->left.load() || !node->right.load()) {
+                return false;
+            }
+        }
+        node->value.store(box);
+        return true;
+    }
+
+    // 调用方已锁住 parent 和 node。用 node 唯一的子节点替换它，
+    // 不调整高度
+    bool attempt_unlink_nl(Link *parent, Node *node) {
+        Node *parent_left  = parent->left.load();
+        Node *parent_right = parent->right.load();
+        if (parent_left != node && parent_right != node) {
+            return false;
+        }
+        Node *left  = node->left.load();
+        Node *right = node->right.load();
+        if (left && right) {
+            return false;
+        }
+        Node *splice = left ? left : right;
+        if (parent_left == node) {
+            parent->left.store(splice);
+        } else {
+            parent->right.store(splice);
+        }
+        if (splice) {
+            splice->parent.store(parent);
+        }
+        node->version.store(unlinked);
+        node->value.store(nullptr);
+        epoch::retire(node);
+        return true;
+    }
+
+    // ---------------- 修复高度和平衡 ----------------
+
+    // 读取节点当前需要的修复。读到的不一致时，改动它的线程会负责修复
+    static int node_condition(Node *node) {
+        Node *left  = node->left.load();
+        Node *right = node->right.load();
+        if ((!left || !right) && !node->value.load()) {
+            return unlink_required;
+        }
+        const int h       = node->height.load();
+        const int h_left  = height(left);
+        const int h_right = height(right);
+        const int h_repl  = 1 + std::max(h_left, h_right);
+        const int balance = h_left - h_right;
+        if (balance < -1 || balance > 1) {
+            return rebalance_required;
+        }
+        return h != h_repl ? h_repl : nothing_required;
+    }
+
+    Node *damaged_parent(Node *node) {
+        Link *parent = node->parent.load();
+        return parent == &holder_ ? nullptr : static_cast<Node *>(parent);
+    }
+
+    // 从 node 开始向上修复，直到不再需要
+    void fix_height_and_rebalance(Node *node) {
+        while (node) {
+            const int condition = node_condition(node);
+            if (condition == nothing_required
+                || node->version.load() == unlinked) {
+                return;
+            }
+            if (condition != unlink_required
+                && condition != rebalance_required) {
+                std::lock_guard<SpinLock> lock(node->lock);
+                node = fix_height_nl(node);
+                continue;
+            }
+            Link                     *parent = node->parent.load();
+            std::lock_guard<SpinLock> parent_lock(parent->lock);
+            if (parent->version.load() != unlinked
+                && node->parent.load() == parent) {
+                std::lock_guard<SpinLock> node_lock(node->lock);
+                node = rebalance_nl(parent, node);
+            }
+        }
+    }
+
+    // 已锁住 link。只修正高度，返回下一个需要修复的节点，没有时为空
+    Node *fix_height_nl(Link *link) {
+        if (link == &holder_) {
+            return nullptr;
+        }
+        Node     *node      = static_cast<Node *>(link);
+        const int condition = node_condition(node);
+        switch (condition) {
+        case rebalance_required:
+        case unlink_required:
+            return node;
+        case nothing_required:
+            return nullptr;
+        default:
+            node->height.store(condition);
+            return damaged_parent(node);
+        }
+    }
+
+    // 已锁住 parent 和 node
+    Node *rebalance_nl(Link *parent, Node *node) {
+        Node *left  = node->left.load();
+        Node *right = node->right.load();
+        if ((!left || !right) && !node->value.load()) {
+            if (attempt_unlink_nl(parent, node)) {
+                return fix_height_nl(parent);
+            }
+            return node;
+        }
+        const int h       = node->height.load();
+        const int h_left  = height(left);
+        const int h_right = height(right);
+        const int h_repl  = 1 + std::max(h_left, h_right);
+        const int balance = h_left - h_right;
+        if (balance > 1) {
+            return rebalance_to_right_nl(parent, node, left, h_right);
+        }
+        if (balance < -1) {
+            return rebalance_to_left_nl(parent, node, right, h_left);
+        }
+        if (h_repl != h) {
+            node->height.store(h_repl);
+            return fix_height_nl(parent);
+        }
+        return nullptr;
+    }
+
+    // 左子树过高，右旋；左子节点的右子树更高时先对左子节点左旋
+    Node *rebalance_to_right_nl(
+        Link *parent, Node *node, Node *left, int h_right) {
+        std::lock_guard<SpinLock> left_lock(left->lock);
+        if (left->height.load() - h_right <= 1) {
+            return node;
+        }
+        Node     *left_right = left->right.load();
+        const int h_ll       = height(left->left.load());
+        const int h_lr0      = height(left_right);
+        if (h_ll >= h_lr0) {
+            return rotate_right_nl(
+                parent, node, left, h_right, h_ll, left_right, h_lr0);
+        }
+        {
+            std::lock_guard<SpinLock> lr_lock(left_right->lock);
+            const int                 h_lr = left_right->height.load();
+            if (h_ll >= h_lr) {
+                return rotate_right_nl(
+                    parent, node, left, h_right, h_ll, left_right, h_lr);
+            }
+            // 双旋后 left 本身仍平衡、且不会留下多余的路由节点时才一步完成，
+            // 否则先单独修好 left，node 之后再处理
+            const int h_lrl = height(left_right->left.load());
+            const int b     = h_ll - h_lrl;
+            if (b >= -1 && b <= 1
+                && !((h_ll == 0 || h_lrl == 0) && !left->value.load())) {
+                return rotate_right_over_left_nl(
+                    parent, node, left, h_right, h_ll, left_right, h_lrl);
+            }
+        }
+        return rebalance_to_left_nl(node, left, left_right, h_ll);
+    }
+
+    Node *rebalance_to_left_nl(
+        Link *parent, Node *node, Node *right, int h_left) {
+        std::lock_guard<SpinLock> right_lock(right->lock);
+        if (h_left - right->height.load() >= -1) {
+            return node;
+        }
+        Node     *right_left = right->left.load();
+        const int h_rl0      = height(right_left);
+        const int h_rr       = height(right->right.load());
+        if (h_rr >= h_rl0) {
+            return rotate_left_nl(
+                parent, node, h_left, right, right_left, h_rl0, h_rr);
+        }
+        {
+            std::lock_guard<SpinLock> rl_lock(right_left->lock);
+            const int                 h_rl = right_left->height.load();
+            if (h_rr >= h_rl) {
+                return rotate_left_nl(
+                    parent, node, h_left, right, right_left, h_rl, h_rr);
+            }
+            const int h_rlr = height(right_left->right.load());
+            const int b     = h_rr - h_rlr;
+            if (b >= -1 && b <= 1
+                && !((h_rr == 0 || h_rlr == 0) && !right->value.load())) {
+                return rotate_left_over_right_nl(
+                    parent, node, h_left, right, right_left, h_rr, h_rlr);
+            }
+        }
+        return rebalance_to_right_nl(node, right, right_left, h_rr);
+    }
+
+    void replace_child(Link *parent, Node *old_child, Node *new_child) {
+        if (parent->left.load() == old_child) {
+            parent->left.store(new_child);
+        } else {
+            parent->right.store(new_child);
+        }
+        new_child->parent.store(parent);
+    }
+
+    // 旋转后 node 下沉、键范围缩小，旋转期间标记 node 正在缩小；
+    // 上升的节点键范围只会变大，不影响读者。
+    // 返回旋转后仍需修复的最深节点
+    Node *rotate_right_nl(
+        Link *parent, Node *node, Node *left, int h_right, int h_ll,
+        Node *left_right, int h_lr) {
+        const uint64_t version = node->version.load();
+        node->version.store(begin_change(version));
+
+        node->left.store(left_right);
+        if (left_right) {
+            left_right->parent.store(node);
+        }
+        left->right.store(node);
+        node->parent.store(left);
+        replace_child(parent, node, left);
+
+        const int h_node = 1 + std::max(h_lr, h_right);
+        node->height.store(h_node);
+        left->height.store(1 + std::max(h_ll, h_node));
+
+        node->version.store(end_change(version));
+
+        const int balance_node = h_lr - h_right;
+        if (balance_node < -1 || balance_node > 1) {
+            return node;
+        }
+        if ((!left_right || h_right == 0) && !node->value.load()) {
+            return node;
+        }
+        const int balance_left = h_ll - h_node;
+        if (balance_left < -1 || balance_left > 1) {
+            return left;
+        }
+        if (h_ll == 0 && !left->value.load()) {
+            return left;
+        }
+        return fix_height_nl(parent);
+    }
+
+    Node *rotate_left_nl(
+        Link *parent, Node *node, int h_left, Node *right, Node *right_left,
+        int h_rl, int h_rr) {
+        const uint64_t version = node->version.load();
+        node->version.store(begin_change(version));
+
+        node->right.store(right_left);
+        if (right_left) {
+            right_left->parent.store(node);
+        }
+        right->left.store(node);
+        node->parent.store(right);
+        replace_child(parent, node, right);
+
+        const int h_node = 1 + std::max(h_left, h_rl);
+        node->height.store(h_node);
+        right->height.store(1 + std::max(h_node, h_rr));
+
+        node->version.store(end_change(version));
+
+        const int balance_node = h_rl - h_left;
+        if (balance_node < -1 || balance_node > 1) {
+            return node;
+        }
+        if ((!right_left || h_left == 0) && !node->value.load()) {
+            return node;
+        }
+        const int balance_right = h_rr - h_node;
+        if (balance_right < -1 || balance_right > 1) {
+            return right;
+        }
+        if (h_rr == 0 && !right->value.load()) {
+            return right;
+        }
+        return fix_height_nl(parent);
+    }
+
+    // 先左旋 left 再右旋 node，node 和 left 的键范围都会缩小
+    Node *rotate_right_over_left_nl(
+        Link *parent, Node *node, Node *left, int h_right, int h_ll,
+        Node *left_right, int h_lrl) {
+        const uint64_t node_version = node->version.load();
+        const uint64_t left_version = left->version.load();
+        Node          *lrl          = left_right->left.load();
+        Node          *lrr          = left_right->right.load();
+        const int      h_lrr        = height(lrr);
+
+        node->version.store(begin_change(node_version));
+        left->version.store(begin_change(left_version));
+
+        node->left.store(lrr);
+        if (lrr) {
+            lrr->parent.store(node);
+        }
+        left->right.store(lrl);
+        if (lrl) {
+            lrl->parent.store(left);
+        }
+        left_right->left.store(left);
+        left->parent.store(left_right);
+        left_right->right.store(node);
+        node->parent.store(left_right);
+        replace_child(parent, node, left_right);
+
+        const int h_node = 1 + std::max(h_lrr, h_right);
+        const int h_left = 1 + std::max(h_ll, h_lrl);
+        node->height.store(h_node);
+        left->height.store(h_left);
+        left_right->height.store(1 + std::max(h_left, h_node));
+
+        node->version.store(end_change(node_version));
+        left->version.store(end_change(left_version));
+
+        const int balance_node = h_lrr - h_right;
+        if (balance_node < -1 || balance_node > 1) {
+            return node;
+        }
+        if ((!lrr || h_right == 0) && !node->value.load()) {
+            return node;
+        }
+        const int balance_top = h_left - h_node;
+        if (balance_top < -1 || balance_top > 1) {
+            return left_right;
+        }
+        return fix_height_nl(parent);
+    }
+
+    Node *rotate_left_over_right_nl(
+        Link *parent, Node *node, int h_left, Node *right, Node *right_left,
+        int h_rr, int h_rlr) {
+        const uint64_t node_version  = node->version.load();
+        const uint64_t right_version = right->version.load();
+        Node          *rll           = right_left->left.load();
+        Node          *rlr           = right_left->right.load();
+        const int      h_rll         = height(rll);
+
+        node->version.store(begin_change(node_version));
+        right->version.store(begin_change(right_version));
+
+        node->right.store(rll);
+        if (rll) {
+            rll->parent.store(node);
+        }
+        right->left.store(rlr);
+        if (rlr) {
+            rlr->parent.store(right);
+        }
+        right_left->right.store(right);
+        right->parent.store(right_left);
+        right_left->left.store(node);
+        node->parent.store(right_left);
+        replace_child(parent, node, right_left);
+
+        const int h_node  = 1 + std::max(h_left, h_rll);
+        const int h_right = 1 + std::max(h_rlr, h_rr);
+        node->height.store(h_node);
+        right->height.store(h_right);
+        right_left->height.store(1 + std::max(h_node, h_right));
+
+        node->version.store(end_change(node_version));
+        right->version.store(end_change(right_version));
+
+        const int balance_node = h_rll - h_left;
+        if (balance_node < -1 || balance_node > 1) {
+            return node;
+        }
+        if ((!rll || h_left == 0) && !node->value.load()) {
+            return node;
+        }
+        const int balance_top = h_right - h_node;
+        if (balance_top < -1 || balance_top > 1) {
+            return right_left;
+        }
+        return fix_height_nl(parent);
+    }
+
+    // 根挂在占位节点的右边，占位节点本身没有键，也从不被摘除或旋转
+    Link holder_;
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// 基于纪元的内存回收：线程进入临界区时登记当时的全局纪元，
+// 摘下的节点连同摘下时的纪元放进退休列表。只有所有临界区内的线程都已看到
+// 当前纪元，全局纪元才能前进；前进两次之后，摘下前进入的线程都已离开，节点可以释放。
+// 与危险指针相比，读者不必逐个保护途经的节点，适合沿树的长路径遍历。
+namespace epoch {
+
+struct alignas(64) Record {
+    Record() : epoch(0), active(false), next(nullptr) {}
+    std::atomic<uint64_t> epoch;   // 0 表示不在临界区内
+    std::atomic<bool>     active;
+    Record               *next;
+};
+
+struct Retired {
+    void    *ptr;
+    void   (*deleter)(void *);
+    uint64_t epoch;
+};
+
+class Domain {
+public:
+    static Domain &instance() {
+        static Domain domain;
+        return domain;
+    }
+
+    Domain(const Domain &)            = delete;
+    Domain &operator=(const Domain &) = delete;
+
+    ~Domain() {
+        for (const Retired &r : orphans_) {
+            r.deleter(r.ptr);
+        }
+        Record *r = head_.load(std::memory_order_acquire);
+        while (r) {
+            Record *next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+
+    Record *acquire() {
+        for (Record *r = head_.load(std::memory_order_acquire); r;
+             r = r->next) {
+            bool idle = false;
+            if (!r->active.load(std::memory_order_relaxed)
+                && r->active.compare_exchange_strong(
+                    idle, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        Record *r = new Record;
+        r->active.store(true, std::memory_order_relaxed);
+        r->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(
+            r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return r;
+    }
+
+    void release(Record *r) {
+        r->epoch.store(0, std::memory_order_release);
+        r->active.store(false, std::memory_order_release);
+    }
+
+    uint64_t current() const noexcept {
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    // 释放 retired 中已经安全的节点，其余留在 retired 中。
+    // 顺带接管已退出线程遗留的节点
+    void reclaim(std::vector<Retired> &retired) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            retired.insert(retired.end(), orphans_.begin(), orphans_.end());
+            orphans_.clear();
+        }
+        const uint64_t now  = try_advance();
+        auto           keep = std::partition(
+            retired.begin(), retired.end(),
+            [&](const Retired &r) { return r.epoch + 2 > now; });
+        for (auto it = keep; it != retired.end(); ++it) {
+            it->deleter(it->ptr);
+        }
+        retired.erase(keep, retired.end());
+    }
+
+    // 退出的线程把尚未安全的节点交给全局列表，由后续扫描处理
+    void abandon(std::vector<Retired> &retired) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        orphans_.insert(orphans_.end(), retired.begin(), retired.end());
+        retired.clear();
+    }
+
+private:
+    Domain() : epoch_(1), head_(nullptr), mutex_(), orphans_() {}
+
+    // 临界区内的线程都停在当前纪元时前进一步，返回最新的纪元
+    uint64_t try_advance() {
+        uint64_t now = current();
+        for (Record *r = head_.load(std::memory_order_acquire); r;
+             r = r->next) {
+            const uint64_t local = r->epoch.load(std::memory_order_seq_cst);
+            if (local != 0 && local != now) {
+                return now;
+            }
+        }
+        if (epoch_.compare_exchange_strong(now, now + 1)) {
+            return now + 1;
+        }
+        return now;
+    }
+
+    std::atomic<uint64_t> epoch_;
+    std::atomic<Record *> head_;
+    std::mutex            mutex_;
+    std::vector<Retired>  orphans_;
+};
+
+// 线程私有的记录和退休列表，临界区可以嵌套
+class ThreadState {
+    static constexpr size_t scan_interval = 64;
+
+public:
+    static ThreadState &local() {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    ThreadState(const ThreadState &)            = delete;
+    ThreadState &operator=(const ThreadState &) = delete;
+
+    ~ThreadState() {
+        Domain &domain = Domain::instance();
+        domain.release(record_);
+        domain.reclaim(retired_);
+        if (!retired_.empty()) {
+            domain.abandon(retired_);
+        }
+    }
+
+    // 登记后再确认一次全局纪元，保证登记的不是已经过时的纪元
+    void enter() {
+        if (depth_++ > 0) {
+            return;
+        }
+        Domain  &domain = Domain::instance();
+        uint64_t seen   = domain.current();
+        for (;;) {
+            record_->epoch.store(seen, std::memory_order_seq_cst);
+            const uint64_t now = domain.current();
+            if (now == seen) {
+                return;
+            }
+            seen = now;
+        }
+    }
+
+    void exit() {
+        if (--depth_ == 0) {
+            record_->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    // 每新增 scan_interval 个退休节点扫描一次，摊销后每个节点 O(1)
+    void retire(void *p, void (*deleter)(void *)) {
+        Domain &domain = Domain::instance();
+        retired_.push_back(Retired{p, deleter, domain.current()});
+        if (retired_.size() >= next_scan_) {
+            domain.reclaim(retired_);
+            next_scan_ = retired_.size() + scan_interval;
+        }
+    }
+
+private:
+    ThreadState()
+        : record_(Domain::instance().acquire())
+        , retired_()
+        , depth_(0)
+        , next_scan_(scan_interval) {}
+
+    Record              *record_;
+    std::vector<Retired> retired_;
+    size_t               depth_;
+    size_t               next_scan_;
+};
+
+// 作用域内的临界区，期间读到的共享节点不会被释放
+class Guard {
+public:
+    Guard() : state_(ThreadState::local()) { state_.enter(); }
+    ~Guard() { state_.exit(); }
+
+    Guard(const Guard &)            = delete;
+    Guard &operator=(const Guard &) = delete;
+
+private:
+    ThreadState &state_;
+};
+
+// 已经摘下、不会再被新的访问者看到的对象，安全后用 delete 释放
+template<typename T> void retire(T *p) {
+    ThreadState::local().retire(
+        p, [](void *q) { delete static_cast<T *>(q); });
+}
+
+} // namespace epoch
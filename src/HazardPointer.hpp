@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// 危险指针：读者在解引用共享节点前把指针登记到自己的记录里，
+// 摘下节点的线程只把它放进退休列表，扫描时跳过仍被登记的节点再释放。
+// 每个线程在第一次使用时占用一条记录，线程退出时归还，记录本身只复用不释放。
+namespace hazard {
+
+struct alignas(64) Record {
+    Record() : ptr(nullptr), active(false), next(nullptr) {}
+    std::atomic<const void *> ptr;
+    std::atomic<bool>         active;
+    Record                   *next;
+};
+
+struct Retired {
+    void *ptr;
+    void (*deleter)(void *);
+};
+
+class Domain {
+public:
+    static Domain &instance() {
+        static Domain domain;
+        return domain;
+    }
+
+    Domain(const Domain &)            = delete;
+    Domain &operator=(const Domain &) = delete;
+
+    ~Domain() {
+        for (const Retired &r : orphans_) {
+            r.deleter(r.ptr);
+        }
+        Record *r = head_.load(std::memory_order_acquire);
+        while (r) {
+            Record *next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+
+    Record *acquire() {
+        for (Record *r = head_.load(std::memory_order_acquire); r;
+             r = r->next) {
+            bool idle = false;
+            if (!r->active.load(std::memory_order_relaxed)
+                && r->active.compare_exchange_strong(
+                    idle, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        Record *r = new Record;
+        r->active.store(true, std::memory_order_relaxed);
+        r->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(
+            r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        count_.fetch_add(1, std::memory_order_relaxed);
+        return r;
+    }
+
+    void release(Record *r) {
+        r->ptr.store(nullptr, std::memory_order_release);
+        r->active.store(false, std::memory_order_release);
+    }
+
+    size_t record_count() const noexcept {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    // 释放 retired 中没有被任何记录保护的节点，其余留在 retired 中。
+    // 顺带接管已退出线程遗留的节点
+    void reclaim(std::vector<Retired> &retired) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            retired.insert(retired.end(), orphans_.begin(), orphans_.end());
+            orphans_.clear();
+        }
+        // 调用方摘下节点的操作不一定是 seq_cst，先用全屏障把它排在
+        // 下面读危险指针之前，否则弱内存序的机器上可能漏掉刚发布的保护
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<const void *> hazards;
+        for (Record *r = head_.load(std::memory_order_acquire); r;
+             r = r->next) {
+            if (const void *p = r->ptr.load(std::memory_order_seq_cst)) {
+                hazards.push_back(p);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+        auto keep = std::partition(
+            retired.begin(), retired.end(), [&](const Retired &r) {
+                return std::binary_search(
+                    hazards.begin(), hazards.end(), r.ptr);
+            });
+        for (auto it = keep; it != retired.end(); ++it) {
+            it->deleter(it->ptr);
+        }
+        retired.erase(keep, retired.end());
+    }
+
+    // 退出的线程把仍被保护的节点交给全局列表，由后续扫描处理
+    void abandon(std::vector<Retired> &retired) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        orphans_.insert(orphans_.end(), retired.begin(), retired.end());
+        retired.clear();
+    }
+
+private:
+    Domain() : head_(nullptr), count_(0), mutex_(), orphans_() {}
+
+    std::atomic<Record *> head_;
+    std::atomic<size_t>   count_;
+    std::mutex            mutex_;
+    std::vector<Retired>  orphans_;
+};
+
+// 线程私有的记录和退休列表
+class ThreadState {
+public:
+    static ThreadState &local() {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    ThreadState(const ThreadState &)            = delete;
+    ThreadState &operator=(const ThreadState &) = delete;
+
+    ~ThreadState() {
+        Domain &domain = Domain::instance();
+        domain.release(record_);
+        domain.reclaim(retired_);
+        if (!retired_.empty()) {
+            domain.abandon(retired_);
+        }
+    }
+
+    // 登记后必须重新确认指针仍然可达，否则节点可能已在登记前被摘下
+    void protect(const void *p) {
+        record_->ptr.store(p, std::memory_order_seq_cst);
+    }
+
+    void clear() { record_->ptr.store(nullptr, std::memory_order_release); }
+
+    // 退休列表超过记录数的两倍时扫描一次，摊销后每个节点 O(1)
+    void retire(void *p, void (*deleter)(void *)) {
+        retired_.push_back(Retired{p, deleter});
+        Domain      &domain = Domain::instance();
+        const size_t threshold =
+            std::max<size_t>(64, 2 * domain.record_count());
+        if (retired_.size() >= threshold) {
+            domain.reclaim(retired_);
+        }
+    }
+
+private:
+    ThreadState() : record_(Domain::instance().acquire()), retired_() {}
+
+    Record              *record_;
+    std::vector<Retired> retired_;
+};
+
+} // namespace hazard
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "HazardPointer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// 无锁栈（Treiber 栈），作为 MyStack 的并发版本。
+// 出栈前用危险指针保护栈顶节点，摘下的节点延迟释放：节点在被保护期间
+// 不会被释放和复用，CAS 比较的地址也就不会出现 ABA。
+// Elimination 为 true 时，CAS 失败的压栈和出栈先到消除数组里直接配对交换，
+// 不再争抢栈顶，高并发下能减少冲突。
+template<typename T, bool Elimination = false> class LockFreeStack {
+    struct Node {
+        template<typename... Args>
+        explicit Node(Args &&...args)
+            : value(std::forward<Args>(args)...), next(nullptr) {}
+        Node(const Node &)            = delete;
+        Node &operator=(const Node &) = delete;
+        T     value;
+        Node *next;
+    };
+
+public:
+    LockFreeStack() : head_(nullptr), exchanger_() {}
+
+    LockFreeStack(const LockFreeStack &)            = delete;
+    LockFreeStack &operator=(const LockFreeStack &) = delete;
+
+    // 析构时不能再有其他线程访问
+    ~LockFreeStack() {
+        Node *node = head_.load(std::memory_order_relaxed);
+        while (node) {
+            Node *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    void push(const T &value) { push_node(new Node(value)); }
+
+    void push(T &&value) { push_node(new Node(std::move(value))); }
+
+    template<typename... Args> void emplace(Args &&...args) {
+        push_node(new Node(std::forward<Args>(args)...));
+    }
+
+    // 栈为空时返回 false
+    bool try_pop(T &out) {
+        hazard::ThreadState &hp = hazard::ThreadState::local();
+        for (;;) {
+            Node *top = head_.load(std::memory_order_acquire);
+            if (!top) {
+                hp.clear();
+                return false;
+            }
+            hp.protect(top);
+            if (head_.load(std::memory_order_seq_cst) != top) {
+                continue;
+            }
+            // 摘下节点的 CAS 与危险指针的发布、扫描处于同一全序中，
+            // 扫描才一定能看到仍在读 top 的线程
+            if (head_.compare_exchange_strong(
+                    top, top->next, std::memory_order_seq_cst,
+                    std::memory_order_relaxed)) {
+                hp.clear();
+                out = std::move(top->value);
+                hp.retire(top, &delete_node);
+                return true;
+            }
+            if constexpr (Elimination) {
+                if (Node *node = exchanger_.take()) {
+                    hp.clear();
+                    out = std::move(node->value);
+                    delete node;
+                    return true;
+                }
+            }
+        }
+    }
+
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    static void delete_node(void *p) { delete static_cast<Node *>(p); }
+
+    void push_node(Node *node) {
+        node->next = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (head_.compare_exchange_weak(
+                    node->next, node, std::memory_order_release,
+                    std::memory_order_relaxed)) {
+                return;
+            }
+            if constexpr (Elimination) {
+                if (exchanger_.offer(node)) {
+                    return;
+                }
+                node->next = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 消除数组：压栈方把节点放进随机槽位等待片刻，出栈方从槽位里取走。
+    // 取走的节点从未进入栈中，归出栈方独占，可以直接释放
+    class Exchanger {
+        static constexpr size_t width      = 8;
+        static constexpr int    spin_limit = 128;
+
+        struct alignas(64) Cell {
+            Cell() : node(nullptr) {}
+            std::atomic<Node *> node;
+        };
+
+    public:
+        Exchanger() : cells_() {}
+
+        bool offer(Node *node) {
+            Cell &cell     = cells_[pick()];
+            Node *expected = nullptr;
+            if (!cell.node.compare_exchange_strong(
+                    expected, node, std::memory_order_release,
+                    std::memory_order_relaxed)) {
+                return false;
+            }
+            for (int i = 0; i < spin_limit; ++i) {
+                if (cell.node.load(std::memory_order_acquire) != node) {
+                    return true;
+                }
+            }
+            // 超时收回；收回失败说明刚好被取走
+            expected = node;
+            return !cell.node.compare_exchange_strong(
+                expected, nullptr, std::memory_order_relaxed);
+        }
+
+        Node *take() {
+            Cell &cell = cells_[pick()];
+            Node *node = cell.node.load(std::memory_order_acquire);
+            if (node
+                && cell.node.compare_exchange_strong(
+                    node, nullptr, std::memory_order_acquire,
+                    std::memory_order_relaxed)) {
+                return node;
+            }
+            return nullptr;
+        }
+
+    private:
+        // 线程私有的 xorshift，避免所有线程挤在同一个槽位
+        static size_t pick() {
+            thread_local uint32_t seed = static_cast<uint32_t>(
+                reinterpret_cast<uintptr_t>(&seed) >> 4) | 1u;
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed % width;
+        }
+
+        Cell cells_[width];
+    };
+
+    struct Empty {};
+
+    alignas(64) std::atomic<Node *> head_;
+    std::conditional_t<Elimination, Exchanger, Empty> exchanger_;
+};
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 以 mmap 映射文件的定长元素数组，接口与 MyArray 保持一致。
+// 文件布局：64 字节文件头（魔数、元素大小、元素个数）后紧跟元素数据。
+// 文件长度即容量，追加时按几何级数 ftruncate 扩展文件并重新映射。
+// 只读模式的映射没有写权限：改变大小的操作会抛异常，经由非 const 的
+// operator[] 或迭代器写入元素会触发 SIGSEGV，而不是被悄悄丢弃。
+template<typename T> class MappedArray {
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "MappedArray only stores trivially copyable types");
+    static_assert(alignof(T) <= 64, "element alignment exceeds the header");
+
+    struct Header {
+        char     magic[8];
+        uint64_t elem_size;
+        uint64_t num_items;
+        char     reserved[40];
+    };
+    static_assert(sizeof(Header) == 64, "header must stay 64 bytes");
+
+    static constexpr char magic_[8] = {'M', 'Y', 'A', 'R', 'R', 'A', 'Y', '1'};
+
+public:
+    using iterator       = T *;
+    using const_iterator = const T *;
+
+    enum class Mode
+    {
+        ReadOnly,
+        ReadWrite
+    };
+
+    // 对应 madvise 的访问模式提示
+    enum class Advice
+    {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed,
+        DontNeed
+    };
+
+    // ReadWrite 模式下文件不存在时会新建
+    MappedArray(const std::string &path, Mode mode)
+        : path_(path), mode_(mode), fd_(-1), map_(nullptr), map_bytes_(0) {
+        const int flags = mode == Mode::ReadOnly ? O_RDONLY : O_RDWR | O_CREAT;
+        fd_             = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            fail("open");
+        }
+
+        try {
+            struct stat st;
+            if (::fstat(fd_, &st) != 0) {
+                fail("fstat");
+            }
+            size_t file_bytes = static_cast<size_t>(st.st_size);
+            if (file_bytes == 0 && mode == Mode::ReadWrite) {
+                file_bytes = bytes_for(initial_capacity());
+                resize_file(file_bytes);
+                map(file_bytes);
+                std::memcpy(header()->magic, magic_, sizeof(magic_));
+                header()->elem_size = sizeof(T);
+                header()->num_items = 0;
+            } else {
+                if (file_bytes < sizeof(Header)) {
+                    throw std::runtime_error(
+                        path_ + ": not a MappedArray file");
+                }
+                map(file_bytes);
+                validate();
+            }
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    MappedArray(const MappedArray &)            = delete;
+    MappedArray &operator=(const MappedArray &) = delete;
+
+    MappedArray(MappedArray &&other) noexcept
+        : path_(std::move(other.path_))
+        , mode_(other.mode_)
+        , fd_(other.fd_)
+        , map_(other.map_)
+        , map_bytes_(other.map_bytes_) {
+        other.fd_        = -1;
+        other.map_       = nullptr;
+        other.map_bytes_ = 0;
+    }
+
+    MappedArray &operator=(MappedArray &&other) noexcept {
+        if (this != &other) {
+            close();
+            path_            = std::move(other.path_);
+            mode_            = other.mode_;
+            fd_              = other.fd_;
+            map_             = other.map_;
+            map_bytes_       = other.map_bytes_;
+            other.fd_        = -1;
+            other.map_       = nullptr;
+            other.map_bytes_ = 0;
+        }
+        return *this;
+    }
+
+    ~MappedArray() { close(); }
+
+    void push_back(const T &element) { emplace_back(element); }
+
+    template<typename... Args> T &emplace_back(Args &&...args) {
+        require_writable();
+        const size_t n = size();
+        if (n == capacity()) {
+            T value(std::forward<Args>(args)...);
+            remap(grow_capacity(n + 1));
+            data()[n] = value;
+        } else {
+            data()[n] = T(std::forward<Args>(args)...);
+        }
+        header()->num_items = n + 1;
+        return data()[n];
+    }
+
+    void pop_back() {
+        require_writable();
+        if (empty()) {
+            throw std::runtime_error("The array is empty");
+        }
+        --header()->num_items;
+    }
+
+    T &operator[](size_t idx) {
+        if (idx >= size()) {
+            throw std::runtime_error("The index is larger than size");
+        }
+        return data()[idx];
+    }
+
+    const T &operator[](size_t idx) const {
+        if (idx >= size()) {
+            throw std::runtime_error("The index is larger than size");
+        }
+        return data()[idx];
+    }
+
+    size_t size() const noexcept {
+        return map_ ? static_cast<size_t>(header()->num_items) : 0;
+    }
+
+    size_t capacity() const noexcept {
+        return map_ ? (map_bytes_ - sizeof(Header)) / sizeof(T) : 0;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    Mode mode() const noexcept { return mode_; }
+
+    const std::string &path() const noexcept { return path_; }
+
+    // 预先扩展文件，避免追加过程中反复重新映射
+    void reserve(size_t new_cap) {
+        require_writable();
+        if (new_cap > capacity()) {
+            remap(new_cap);
+        }
+    }
+
+    // 把文件截断到刚好容纳现有元素
+    void shrink_to_fit() {
+        require_writable();
+        if (size() < capacity()) {
+            remap(std::max(size(), size_t(1)));
+        }
+    }
+
+    void clear() {
+        require_writable();
+        header()->num_items = 0;
+    }
+
+    // 把脏页写回文件；sync 为 false 时只发起异步写回
+    void flush(bool sync = true) {
+        if (mode_ == Mode::ReadOnly || !map_) {
+            return;
+        }
+        if (::msync(map_, map_bytes_, sync ? MS_SYNC : MS_ASYNC) != 0) {
+            fail("msync");
+        }
+    }
+
+    // 对 [first, first + count) 个元素给出访问模式提示，count 为 0 表示到末尾
+    void advise(Advice advice, size_t first = 0, size_t count = 0) {
+        if (!map_ || first >= capacity()) {
+            return;
+        }
+        if (count == 0 || count > capacity() - first) {
+            count = capacity() - first;
+        }
+        // madvise 要求起始地址按页对齐
+        const size_t page  = page_size();
+        size_t       begin = sizeof(Header) + first * sizeof(T);
+        size_t       end   = begin + count * sizeof(T);
+        begin -= begin % page;
+        if (::madvise(
+                static_cast<char *>(map_) + begin, end - begin,
+                to_madvise(advice))
+            != 0) {
+            fail("madvise");
+        }
+    }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size(); }
+
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size(); }
+
+    const_iterator cbegin() const { return data(); }
+
+    const_iterator cend() const { return data() + size(); }
+
+private:
+    [[noreturn]] void fail(const char *what) const {
+        throw std::runtime_error(
+            path_ + ": " + what + " failed: " + std::strerror(errno));
+    }
+
+    static size_t page_size() {
+        static const size_t page =
+            static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+    static size_t bytes_for(size_t cap) {
+        return sizeof(Header) + cap * sizeof(T);
+    }
+
+    // 新文件至少占满一页
+    static size_t initial_capacity() {
+        return std::max(
+            size_t(1), (page_size() - sizeof(Header)) / sizeof(T));
+    }
+
+    static int to_madvise(Advice advice) {
+        switch (advice) {
+        case Advice::Sequential: return MADV_SEQUENTIAL;
+        case Advice::Random: return MADV_RANDOM;
+        case Advice::WillNeed: return MADV_WILLNEED;
+        case Advice::DontNeed: return MADV_DONTNEED;
+        default: return MADV_NORMAL;
+        }
+    }
+
+    Header *header() const noexcept { return static_cast<Header *>(map_); }
+
+    T *data() const noexcept {
+        if (!map_) {
+            return nullptr;
+        }
+        char *base = static_cast<char *>(map_);
+        return reinterpret_cast<T *>(base + sizeof(Header));
+    }
+
+    void require_writable() const {
+        if (mode_ == Mode::ReadOnly) {
+            throw std::runtime_error(path_ + ": array is mapped read-only");
+        }
+    }
+
+    void validate() const {
+        const Header *h = header();
+        if (std::memcmp(h->magic, magic_, sizeof(magic_)) != 0) {
+            throw std::runtime_error(path_ + ": not a MappedArray file");
+        }
+        if (h->elem_size != sizeof(T)) {
+            throw std::runtime_error(path_ + ": element size mismatch");
+        }
+        if (h->num_items > capacity()) {
+            throw std::runtime_error(path_ + ": file is truncated");
+        }
+    }
+
+    size_t grow_capacity(size_t required) const noexcept {
+        return std::max(required, capacity() * 2);
+    }
+
+    void resize_file(size_t bytes) {
+        if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            fail("ftruncate");
+        }
+    }
+
+    void map(size_t bytes) {
+        const int prot =
+            mode_ == Mode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+        void *p = ::mmap(nullptr, bytes, prot, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            fail("mmap");
+        }
+        map_       = p;
+        map_bytes_ = bytes;
+    }
+
+    void remap(size_t new_cap) {
+        const size_t bytes = bytes_for(new_cap);
+        resize_file(bytes);
+#if defined(__linux__)
+        void *p = ::mremap(map_, map_bytes_, bytes, MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) {
+            fail("mremap");
+        }
+        map_       = p;
+        map_bytes_ = bytes;
+#else
+        ::munmap(map_, map_bytes_);
+        map_ = nullptr;
+        map(bytes);
+#endif
+    }
+
+    void close() noexcept {
+        if (map_) {
+            ::munmap(map_, map_bytes_);
+            map_       = nullptr;
+            map_bytes_ = 0;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    std::string path_;
+    Mode        mode_;
+    int         fd_;
+    void       *map_;
+    size_t      map_bytes_;
+};
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+// 多生产者 / 多消费者的有界队列，每个槽位带一个序号（Vyukov 算法）。
+// 槽位序号等于 pos 时可写入、等于 pos + 1 时可读取，读取后推进到下一圈；
+// 生产者和消费者只在各自的计数器上做一次 CAS，互不加锁。
+// try_* 立即返回；push / pop 先自旋、再让出时间片，最后挂到条件变量上；
+// try_push_for / try_pop_for 等系列在超时后返回 false。
+template<typename T> class MpmcQueue {
+    static constexpr size_t cache_line    = 64;
+    static constexpr int    spin_limit    = 64;
+    static constexpr int    yield_limit   = 16;
+    static constexpr auto   park_interval = std::chrono::milliseconds(50);
+
+public:
+    explicit MpmcQueue(size_t capacity)
+        : mask_(round_up(capacity) - 1)
+        , slots_(std::allocator<Slot>().allocate(mask_ + 1))
+        , tail_()
+        , head_()
+        , park_()
+        , pop_waiters_(0)
+        , push_waiters_(0) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            ::new (static_cast<void *>(slots_ + i)) Slot(i);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &)            = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    ~MpmcQueue() {
+        const size_t tail = tail_.pos.load(std::memory_order_relaxed);
+        for (size_t pos = head_.pos.load(std::memory_order_relaxed);
+             pos != tail; ++pos) {
+            std::destroy_at(slots_[pos & mask_].ptr());
+        }
+        std::destroy_n(slots_, mask_ + 1);
+        std::allocator<Slot>().deallocate(slots_, mask_ + 1);
+    }
+
+    bool try_push(const T &value) { return try_emplace(value); }
+
+    bool try_push(T &&value) { return try_emplace(std::move(value)); }
+
+    template<typename... Args> bool try_emplace(Args &&...args) {
+        if (!enqueue(std::forward<Args>(args)...)) {
+            return false;
+        }
+        wake(pop_waiters_, park_.not_empty);
+        return true;
+    }
+
+    bool try_pop(T &out) {
+        if (!dequeue(out)) {
+            return false;
+        }
+        wake(push_waiters_, park_.not_full);
+        return true;
+    }
+
+    void push(const T &value) { push_until(value, time_point::max()); }
+
+    void push(T &&value) { push_until(std::move(value), time_point::max()); }
+
+    void pop(T &out) { pop_until(out, time_point::max()); }
+
+    template<typename U, typename Rep, typename Period>
+    bool try_push_for(U &&value, std::chrono::duration<Rep, Period> timeout) {
+        return push_until(std::forward<U>(value), deadline(timeout));
+    }
+
+    template<typename Rep, typename Period>
+    bool try_pop_for(T &out, std::chrono::duration<Rep, Period> timeout) {
+        return pop_until(out, deadline(timeout));
+    }
+
+    template<typename U, typename Clock, typename Duration>
+    bool try_push_until(
+        U &&value, std::chrono::time_point<Clock, Duration> when) {
+        return push_until(
+            std::forward<U>(value), deadline(when - Clock::now()));
+    }
+
+    template<typename Clock, typename Duration>
+    bool try_pop_until(T &out, std::chrono::time_point<Clock, Duration> when) {
+        return pop_until(out, deadline(when - Clock::now()));
+    }
+
+    // 并发修改时只是近似值
+    size_t size() const noexcept {
+        const size_t head = head_.pos.load(std::memory_order_acquire);
+        const size_t tail = tail_.pos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    size_t capacity() const noexcept { return mask_ + 1; }
+
+private:
+    using clock      = std::chrono::steady_clock;
+    using time_point = clock::time_point;
+
+    struct alignas(cache_line) Slot {
+        explicit Slot(size_t s) : seq(s), storage() {}
+
+        T *ptr() noexcept { return reinterpret_cast<T *>(storage); }
+
+        std::atomic<size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct alignas(cache_line) Cursor {
+        Cursor() : pos(0) {}
+        std::atomic<size_t> pos;
+    };
+
+    // 停车用的锁和条件变量，只有真正需要等待时才会碰到
+    struct Park {
+        Park() : mutex(), not_empty(), not_full() {}
+        std::mutex              mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+    };
+
+    static size_t round_up(size_t n) {
+        size_t cap = 2;
+        while (cap < n) {
+            cap *= 2;
+        }
+        return cap;
+    }
+
+    template<typename Rep, typename Period>
+    static time_point deadline(std::chrono::duration<Rep, Period> timeout) {
+        return clock::now()
+               + std::chrono::duration_cast<time_point::duration>(timeout);
+    }
+
+    // 在 cursor 上抢占一个槽位。生产者 lag 为 0，消费者为 1；
+    // 槽位序号落后说明队列满（或空），返回 nullptr
+    Slot *claim(std::atomic<size_t> &cursor, size_t &pos, size_t lag) {
+        pos = cursor.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot        *slot = slots_ + (pos & mask_);
+            const size_t seq  = slot->seq.load(std::memory_order_acquire);
+            const auto   diff = static_cast<std::ptrdiff_t>(seq - (pos + lag));
+            if (diff == 0) {
+                if (cursor.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    return slot;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = cursor.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename... Args> bool enqueue(Args &&...args) {
+        size_t pos  = 0;
+        Slot  *slot = claim(tail_.pos, pos, 0);
+        if (!slot) {
+            return false;
+        }
+        ::new (static_cast<void *>(slot->ptr())) T(std::forward<Args>(args)...);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool dequeue(T &out) {
+        size_t pos  = 0;
+        Slot  *slot = claim(head_.pos, pos, 1);
+        if (!slot) {
+            return false;
+        }
+        out = std::move(*slot->ptr());
+        std::destroy_at(slot->ptr());
+        slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 与 wait_until 中的登记配对，两边的 seq_cst 栅栏保证不会丢失唤醒
+    void wake(std::atomic<int> &waiters, std::condition_variable &cv) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(park_.mutex);
+            cv.notify_one();
+        }
+    }
+
+    // 先自旋，再让出时间片，最后挂起直到 attempt 成功或超时。
+    // 持锁期间 attempt 不能唤醒对方，否则会重复加锁，成功后由调用方唤醒
+    template<typename Attempt>
+    bool wait_until(
+        Attempt &&attempt, std::atomic<int> &waiters,
+        std::condition_variable &cv, time_point when) {
+        for (int i = 0; i < spin_limit + yield_limit; ++i) {
+            if (attempt()) {
+                return true;
+            }
+            if (i >= spin_limit) {
+                std::this_thread::yield();
+            }
+        }
+        std::unique_lock<std::mutex> lock(park_.mutex);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ok = attempt();
+        while (!ok) {
+            if (when == time_point::max()) {
+                // 不设期限时也定期醒来重试，兜底任何遗漏的唤醒
+                cv.wait_for(lock, park_interval);
+            } else if (cv.wait_until(lock, when) == std::cv_status::timeout) {
+                ok = attempt();
+                break;
+            }
+            ok = attempt();
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    template<typename U> bool push_until(U &&value, time_point when) {
+        // enqueue 只在抢到槽位后才会移走 value，失败重试是安全的
+        const bool ok = wait_until(
+            [&] { return enqueue(std::forward<U>(value)); }, push_waiters_,
+            park_.not_full, when);
+        if (ok) {
+            wake(pop_waiters_, park_.not_empty);
+        }
+        return ok;
+    }
+
+    bool pop_until(T &out, time_point when) {
+        const bool ok = wait_until(
+            [&] { return dequeue(out); }, pop_waiters_, park_.not_empty, when);
+        if (ok) {
+            wake(push_waiters_, park_.not_full);
+        }
+        return ok;
+    }
+
+    const size_t     mask_;
+    Slot *const      slots_;
+    Cursor           tail_;
+    Cursor           head_;
+    Park             park_;
+    std::atomic<int> pop_waiters_;
+    std::atomic<int> push_waiters_;
+};
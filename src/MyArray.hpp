@@ -1,37 +1,61 @@
 #pragma once
 
+#include "Relocate.hpp"
 #include <algorithm>
+#include <cstring>
 #include <initializer_list>
-#include <iostream>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 
+// 对象内的未初始化存储，供 MyArray 的小缓冲区使用
+template<typename T, size_t N> struct InlineBuffer {
+    // 故意不初始化 bytes，元素由 MyArray 按需构造
+    InlineBuffer() noexcept {}
+
+    T *data() noexcept { return reinterpret_cast<T *>(bytes); }
+    const T *data() const noexcept {
+        return reinterpret_cast<const T *>(bytes);
+    }
+
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+};
+
+template<typename T> struct InlineBuffer<T, 0> {
+    T       *data() noexcept { return nullptr; }
+    const T *data() const noexcept { return nullptr; }
+};
+
+// 前 SIZE 个元素存放在对象内部，超出后才溢出到堆上
 template<typename T, size_t SIZE = 0> class MyArray {
+    static constexpr bool trivial_relocate =
+        relocation::is_trivially_relocatable_v<T>;
+    static constexpr bool nothrow_relocate =
+        relocation::is_nothrow_relocatable_v<T>;
+
 public:
+    using iterator       = T *;
+    using const_iterator = const T *;
 
-    constexpr MyArray() {
-        num_items = SIZE;
-        if (num_items) {
-            data_ = std::unique_ptr<T[]>(new T[num_items]);
-        } else {
-            data_ = nullptr;
+    MyArray() : MyArray(empty_tag{}) {
+        if constexpr (SIZE > 0) {
+            std::uninitialized_value_construct_n(data_, SIZE);
+            num_items = SIZE;
         }
     }
 
-    MyArray(const std::initializer_list<T> &ilist) {
-        num_items = SIZE;
-        if (ilist.size()) {
-            data_      = std::unique_ptr<T[]>(new T[num_items]());
-            std::copy(ilist.begin(), ilist.end(), data_.get());
-        } else {
-            data_ = nullptr;
-        }
+    MyArray(const std::initializer_list<T> &ilist) : MyArray(empty_tag{}) {
+        reserve(std::max(SIZE, ilist.size()));
+        std::uninitialized_copy(ilist.begin(), ilist.end(), data_);
+        num_items = ilist.size();
     }
 
-    MyArray(const MyArray &other) {
+    MyArray(const MyArray &other) : MyArray(empty_tag{}) {
+        reserve(other.num_items);
+        copy_construct(other.begin(), other.num_items, data_);
         num_items = other.num_items;
-        data_     = std::unique_ptr<T[]>(new T[num_items]());
-        std::copy(other.begin(), other.end(), this->data_.get());
     }
 
     MyArray &operator=(const MyArray &other) {
@@ -39,96 +63,213 @@ public:
             return *this;
         }
 
-        if (!this->empty()) {
-            clear();
-        }
-
+        clear();
+        reserve(other.num_items);
+        copy_construct(other.begin(), other.num_items, data_);
         num_items = other.num_items;
-        data_.reset(new T[num_items]());
-        std::copy(other.begin(), other.end(), this->data_.get());
         return *this;
     }
 
 
     MyArray &operator=(const std::initializer_list<T> &ilist) {
+        clear();
+        reserve(ilist.size());
+        std::uninitialized_copy(ilist.begin(), ilist.end(), data_);
         num_items = ilist.size();
-        if (num_items) {
-            data_ = std::unique_ptr<T[]>(new T[num_items]);
-            std::copy(ilist.begin(), ilist.end(), data_.get());
-        } else {
-            data_ = nullptr;
-        }
         return *this;
     }
 
-    MyArray(MyArray &&other) noexcept
-        : num_items(other.num_items), data_(std::move(other.data_)) {
-        other.num_items = 0;
+    MyArray(MyArray &&other) noexcept(nothrow_relocate)
+        : MyArray(empty_tag{}) {
+        steal(other);
     }
 
-    MyArray &operator=(MyArray &&other) noexcept {
+    MyArray &operator=(MyArray &&other) noexcept(nothrow_relocate) {
         if (this == &other) {
             return *this;
         }
 
-        num_items       = other.num_items;
-        other.num_items = 0;
-        data_.reset(other.data_.release());
+        release();
+        steal(other);
         return *this;
     }
 
-    ~MyArray() { clear(); }
+    ~MyArray() { release(); }
 
     template<typename U> void insert(U &&element) {
-        std::unique_ptr<T[]> new_data_(new T[num_items + 1]());
-        for (size_t i = 0; i < num_items; i++) {
-            new_data_[i] = data_[i];
-        }
-        new_data_[num_items] = element;
-        num_items++;
-        data_ = std::move(new_data_);
+        emplace_back(std::forward<U>(element));
     }
 
     template<typename U> void insert(U &&element, size_t pos) {
         if (pos > num_items) {
             throw std::runtime_error("The index is larger than the size");
-            std::cerr << "size: " << this->size() << std::endl;
         }
 
-        
-        const size_t current_size = num_items;
-        auto new_data_ = std::make_unique<T[]>(current_size + 1);
-        for (size_t i = 0, j = 0; i < num_items; i++, j++) {
-            if (i == pos) {
-                new_data_[j++] = std::forward<U>(element);
+        if (num_items == capacity_) {
+            // 新元素直接构造在新缓冲区中，前后两段各做一次整体搬迁
+            const size_t new_cap = grow_capacity(num_items + 1);
+            T           *new_data_ = allocate(new_cap);
+            try {
+                ::new (static_cast<void *>(new_data_ + pos))
+                    T(std::forward<U>(element));
+            } catch (...) {
+                deallocate(new_data_, new_cap);
+                throw;
+            }
+            relocate_around(new_data_, new_cap, pos, 1);
+        } else if (pos == num_items) {
+            ::new (static_cast<void *>(data_ + pos))
+                T(std::forward<U>(element));
+        } else {
+            // element 可能引用本数组中的元素，先取出值再移动
+            T value(std::forward<U>(element));
+            if constexpr (trivial_relocate) {
+                std::memmove(
+                    static_cast<void *>(data_ + pos + 1), data_ + pos,
+                    (num_items - pos) * sizeof(T));
+                ::new (static_cast<void *>(data_ + pos)) T(std::move(value));
+            } else {
+                ::new (static_cast<void *>(data_ + num_items))
+                    T(std::move(data_[num_items - 1]));
+                std::move_backward(
+                    data_ + pos, data_ + num_items - 1, data_ + num_items);
+                data_[pos] = std::move(value);
+            }
+        }
+        ++num_items;
+    }
+
+    void push_back(const T &element) { emplace_back(element); }
+
+    void push_back(T &&element) { emplace_back(std::move(element)); }
+
+    // 容量不足时按几何级数扩容，均摊 O(1)
+    template<typename... Args> T &emplace_back(Args &&...args) {
+        if (num_items == capacity_) {
+            // 先在新缓冲区中构造，参数可能引用旧缓冲区中的元素
+            const size_t new_cap = grow_capacity(num_items + 1);
+            T           *new_data_ = allocate(new_cap);
+            try {
+                ::new (static_cast<void *>(new_data_ + num_items))
+                    T(std::forward<Args>(args)...);
+            } catch (...) {
+                deallocate(new_data_, new_cap);
+                throw;
             }
-            new_data_[j] = std::move(data_[i]);
+            relocate_around(new_data_, new_cap, num_items, 1);
+        } else {
+            ::new (static_cast<void *>(data_ + num_items))
+                T(std::forward<Args>(args)...);
         }
-        
-        
-        new_data_[pos] = std::forward<U>(element);
+        return data_[num_items++];
+    }
 
-        data_ = std::move(new_data_);
+    void pop_back() {
+        if (empty()) {
+            throw std::runtime_error("The array is empty");
+        }
+        std::destroy_at(data_ + --num_items);
     }
 
     void remove(size_t pos) {
         if (pos >= num_items) {
             throw std::runtime_error("The index is larger than the size");
         }
-        if (empty()) {
-            return;
+        if constexpr (trivial_relocate) {
+            std::destroy_at(data_ + pos);
+            std::memmove(
+                static_cast<void *>(data_ + pos), data_ + pos + 1,
+                (num_items - pos - 1) * sizeof(T));
+            --num_items;
+        } else {
+            std::move(data_ + pos + 1, data_ + num_items, data_ + pos);
+            std::destroy_at(data_ + --num_items);
+        }
+    }
+
+    // 插入 [first, last)，最多一次重新分配；区间不能指向本数组
+    template<
+        typename It,
+        typename = typename std::iterator_traits<It>::iterator_category>
+    iterator insert(const_iterator pos, It first, It last) {
+        const size_t idx = static_cast<size_t>(pos - data_);
+        if (idx > num_items) {
+            throw std::runtime_error("The index is larger than the size");
         }
-        std::unique_ptr<T[]> new_data_(new T[num_items - 1]());
-        for (size_t i = 0, j = 0; i < num_items; i++, j++) {
-            if (i == pos) {
-                j--;
-                continue;
+        using category = typename std::iterator_traits<It>::iterator_category;
+        if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category>) {
+            // 单遍迭代器先收集起来，再按前向区间插入。
+            // 默认构造会填入 SIZE 个元素，这里要从空数组开始
+            MyArray tmp(empty_tag{});
+            for (; first != last; ++first) {
+                tmp.emplace_back(*first);
             }
-            new_data_[j] = data_[i];
+            return insert(
+                pos, std::make_move_iterator(tmp.begin()),
+                std::make_move_iterator(tmp.end()));
+        } else {
+            const size_t n = static_cast<size_t>(std::distance(first, last));
+            if (n == 0) {
+                return data_ + idx;
+            }
+            if (num_items + n > capacity_) {
+                const size_t new_cap   = grow_capacity(num_items + n);
+                T           *new_data_ = allocate(new_cap);
+                try {
+                    std::uninitialized_copy(first, last, new_data_ + idx);
+                } catch (...) {
+                    deallocate(new_data_, new_cap);
+                    throw;
+                }
+                relocate_around(new_data_, new_cap, idx, n);
+            } else if constexpr (
+                trivial_relocate
+                && std::is_nothrow_constructible_v<
+                    T, typename std::iterator_traits<It>::reference>) {
+                std::memmove(
+                    static_cast<void *>(data_ + idx + n), data_ + idx,
+                    (num_items - idx) * sizeof(T));
+                std::uninitialized_copy(first, last, data_ + idx);
+            } else {
+                insert_in_place(idx, n, first, last);
+            }
+            num_items += n;
+            return data_ + idx;
         }
+    }
 
-        --num_items;
-        data_ = std::move(new_data_);
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    // 删除 [first, last)，尾部元素整体前移一次
+    iterator erase(const_iterator first, const_iterator last) {
+        const size_t from = static_cast<size_t>(first - data_);
+        const size_t to   = static_cast<size_t>(last - data_);
+        if (from > to || to > num_items) {
+            throw std::runtime_error("The range is out of the array");
+        }
+        if (from == to) {
+            return data_ + from;
+        }
+        if constexpr (trivial_relocate) {
+            std::destroy(data_ + from, data_ + to);
+            std::memmove(
+                static_cast<void *>(data_ + from), data_ + to,
+                (num_items - to) * sizeof(T));
+        } else {
+            std::move(data_ + to, data_ + num_items, data_ + from);
+            std::destroy(data_ + num_items - (to - from), data_ + num_items);
+        }
+        num_items -= to - from;
+        return data_ + from;
+    }
+
+    // 单遍压缩删除所有满足 pred 的元素，返回删除的个数
+    template<typename Pred> size_t erase_if(Pred pred) {
+        iterator new_end = std::remove_if(begin(), end(), pred);
+        size_t   removed = static_cast<size_t>(end() - new_end);
+        std::destroy(new_end, end());
+        num_items -= removed;
+        return removed;
     }
 
     T &operator[](size_t idx) {
@@ -147,30 +288,180 @@ public:
 
     size_t size() const noexcept { return num_items; }
 
+    size_t capacity() const noexcept { return capacity_; }
+
     bool empty() const noexcept { return num_items == 0; }
 
-    void clear() {
-        data_.reset();
+    // 只在 new_cap 大于当前容量时重新分配
+    void reserve(size_t new_cap) {
+        if (new_cap > capacity_) {
+            reallocate(new_cap);
+        }
+    }
+
+    // 元素能放回对象内部时释放堆内存
+    void shrink_to_fit() {
+        if (num_items == capacity_ || !on_heap()) {
+            return;
+        }
+        if (num_items <= SIZE) {
+            T *inline_data = inline_.data();
+            relocation::relocate(data_, num_items, inline_data);
+            free_storage();
+            data_     = inline_data;
+            capacity_ = SIZE;
+            return;
+        }
+        reallocate(num_items);
+    }
+
+    // 析构元素但保留已分配的容量
+    void clear() noexcept {
+        std::destroy_n(data_, num_items);
         num_items = 0;
     }
 
-    void swap(MyArray &other) noexcept {
-        std::swap(num_items, other.num_items);
-        std::swap(data_, other.data_);
+    // 两边都在堆上时只交换指针，否则退化为三次移动
+    void swap(MyArray &other) noexcept(nothrow_relocate) {
+        if (this == &other) {
+            return;
+        }
+        if (on_heap() && other.on_heap()) {
+            std::swap(num_items, other.num_items);
+            std::swap(capacity_, other.capacity_);
+            std::swap(data_, other.data_);
+            return;
+        }
+        MyArray tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    // 元素是否已溢出到堆上
+    bool on_heap() const noexcept {
+        return data_ != inline_.data();
     }
 
 
-    using iterator       = T *;
-    using const_iterator = const T *;
+    iterator begin() { return data_; }
+    iterator end() { return data_ + num_items; }
 
-    iterator begin() { return data_.get(); }
-    iterator end() { return data_.get() + num_items; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + num_items; }
 
-    const_iterator cbegin() const { return data_.get(); }
+    const_iterator cbegin() const { return data_; }
 
-    const_iterator cend() const { return data_.get() + num_items; }
+    const_iterator cend() const { return data_ + num_items; }
 
 private:
-    std::unique_ptr<T[]> data_;
-    size_t               num_items;
+    struct empty_tag {};
+
+    explicit MyArray(empty_tag)
+        : inline_(), data_(inline_.data()), num_items(0), capacity_(SIZE) {}
+
+    static T *allocate(size_t n) {
+        return std::allocator<T>().allocate(n);
+    }
+
+    static void deallocate(T *p, size_t n) noexcept {
+        if (p) {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    // 扩容的后半步：new_data 的 [pos, pos + n) 已经构造好新元素，
+    // 把现有元素搬到它两侧并换上新缓冲区。搬迁失败时销毁新元素、
+    // 归还新缓冲区，数组保持原样
+    void relocate_around(T *new_data, size_t new_cap, size_t pos, size_t n) {
+        try {
+            relocation::relocate(
+                data_, pos, new_data, data_ + pos, num_items - pos,
+                new_data + pos + n);
+        } catch (...) {
+            std::destroy_n(new_data + pos, n);
+            deallocate(new_data, new_cap);
+            throw;
+        }
+        free_storage();
+        data_     = new_data;
+        capacity_ = new_cap;
+    }
+
+    static void copy_construct(const T *src, size_t n, T *dst) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (n) {
+                std::memcpy(static_cast<void *>(dst), src, n * sizeof(T));
+            }
+        } else {
+            std::uninitialized_copy_n(src, n, dst);
+        }
+    }
+
+    // 容量足够时在原地为 [first, last) 腾出位置，与 std::vector 的做法相同
+    template<typename It>
+    void insert_in_place(size_t idx, size_t n, It first, It last) {
+        T           *pos         = data_ + idx;
+        T           *old_end     = data_ + num_items;
+        const size_t elems_after = num_items - idx;
+        if (elems_after > n) {
+            std::uninitialized_move(old_end - n, old_end, old_end);
+            std::move_backward(pos, old_end - n, old_end);
+            std::copy(first, last, pos);
+        } else {
+            It mid = std::next(first, static_cast<std::ptrdiff_t>(elems_after));
+            std::uninitialized_copy(mid, last, old_end);
+            std::uninitialized_move(pos, old_end, pos + n);
+            std::copy(first, mid, pos);
+        }
+    }
+
+    size_t grow_capacity(size_t required) const noexcept {
+        return std::max(required, capacity_ ? capacity_ * 2 : size_t(1));
+    }
+
+    void reallocate(size_t new_cap) {
+        T *new_data_ = allocate(new_cap);
+        try {
+            relocation::relocate(data_, num_items, new_data_);
+        } catch (...) {
+            deallocate(new_data_, new_cap);
+            throw;
+        }
+        free_storage();
+        data_     = new_data_;
+        capacity_ = new_cap;
+    }
+
+    void free_storage() noexcept {
+        if (on_heap()) {
+            deallocate(data_, capacity_);
+        }
+    }
+
+    // 析构所有元素并回到空的内联状态
+    void release() noexcept {
+        clear();
+        free_storage();
+        data_     = inline_.data();
+        capacity_ = SIZE;
+    }
+
+    // 接管 other 的元素：堆上的直接转移指针，内联的逐个搬迁
+    void steal(MyArray &other) noexcept(nothrow_relocate) {
+        if (other.on_heap()) {
+            data_           = other.data_;
+            capacity_       = other.capacity_;
+            other.data_     = other.inline_.data();
+            other.capacity_ = SIZE;
+        } else {
+            relocation::relocate(other.data_, other.num_items, data_);
+        }
+        num_items       = other.num_items;
+        other.num_items = 0;
+    }
+
+    InlineBuffer<T, SIZE> inline_;
+    T                    *data_;
+    size_t num_items;
+    size_t capacity_;
 };
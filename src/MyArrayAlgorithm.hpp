@@ -0,0 +1,549 @@
+#pragma once
+
+#include "MyArray.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    define MYARRAY_SIMD_X86 1
+#    include <immintrin.h>
+#else
+#    define MYARRAY_SIMD_X86 0
+#endif
+
+// MyArray 连续存储上的批量数值算法。
+// int / float 在运行时按 CPU 支持选择 AVX2、SSE4.2 或标量实现，
+// 其他算术类型只有标量实现。浮点的 sum / dot 会改变累加顺序，
+// 与标量结果可能有舍入误差；含 NaN 时 min / max 的结果未定义。
+namespace simd {
+
+enum class Isa
+{
+    Scalar,
+    SSE42,
+    AVX2
+};
+
+inline const char* isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::AVX2: return "avx2";
+    case Isa::SSE42: return "sse4.2";
+    default: return "scalar";
+    }
+}
+
+// 当前 CPU 支持的最高指令集，只检测一次
+inline Isa detect_isa() {
+    static const Isa isa = [] {
+#if MYARRAY_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return Isa::SSE42;
+#endif
+        return Isa::Scalar;
+    }();
+    return isa;
+}
+
+inline bool isa_supported(Isa isa) { return isa <= detect_isa(); }
+
+// 整数累加到 long long 以免溢出，浮点保持原类型
+template<typename T>
+using sum_t = std::conditional_t<std::is_integral_v<T>, long long, T>;
+
+template<typename T> struct Kernels {
+    const T* (*find)(const T*, const T*, T);
+    size_t (*count)(const T*, const T*, T);
+    T (*min)(const T*, const T*);
+    T (*max)(const T*, const T*);
+    sum_t<T> (*sum)(const T*, const T*);
+    sum_t<T> (*dot)(const T*, const T*, const T*);
+};
+
+namespace detail {
+
+template<typename T> const T* find_scalar(const T* first, const T* last, T v) {
+    return std::find(first, last, v);
+}
+
+template<typename T>
+size_t count_scalar(const T* first, const T* last, T v) {
+    return static_cast<size_t>(std::count(first, last, v));
+}
+
+template<typename T> T min_scalar(const T* first, const T* last) {
+    return *std::min_element(first, last);
+}
+
+template<typename T> T max_scalar(const T* first, const T* last) {
+    return *std::max_element(first, last);
+}
+
+template<typename T> sum_t<T> sum_scalar(const T* first, const T* last) {
+    return std::accumulate(first, last, sum_t<T>(0));
+}
+
+template<typename T>
+sum_t<T> dot_scalar(const T* first, const T* last, const T* other) {
+    sum_t<T> acc(0);
+    for (; first != last; ++first, ++other) {
+        acc += sum_t<T>(*first) * sum_t<T>(*other);
+    }
+    return acc;
+}
+
+template<typename T> const Kernels<T>& scalar_kernels() {
+    static const Kernels<T> k{
+        find_scalar<T>, count_scalar<T>, min_scalar<T>,
+        max_scalar<T>,  sum_scalar<T>,   dot_scalar<T>};
+    return k;
+}
+
+#if MYARRAY_SIMD_X86
+
+// 比较结果掩码中置位的通道数 / 第一个置位的通道
+inline size_t lane_count(int mask) {
+    return static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+}
+
+inline int first_lane(int mask) {
+    return __builtin_ctz(static_cast<unsigned>(mask));
+}
+
+template<typename T, size_t N> T reduce_min(const T (&lanes)[N]) {
+    return *std::min_element(lanes, lanes + N);
+}
+
+template<typename T, size_t N> T reduce_max(const T (&lanes)[N]) {
+    return *std::max_element(lanes, lanes + N);
+}
+
+template<typename S, typename T, size_t N> S reduce_sum(const T (&lanes)[N]) {
+    return std::accumulate(lanes, lanes + N, S(0));
+}
+
+/* ---------------- AVX2 ---------------- */
+
+__attribute__((target("avx2"))) inline const int*
+find_avx2(const int* first, const int* last, int v) {
+    const __m256i needle = _mm256_set1_epi32(v);
+    for (; last - first >= 8; first += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        int     mask = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(x, needle)));
+        if (mask) return first + first_lane(mask);
+    }
+    return std::find(first, last, v);
+}
+
+__attribute__((target("avx2"))) inline size_t
+count_avx2(const int* first, const int* last, int v) {
+    const __m256i needle = _mm256_set1_epi32(v);
+    size_t        n      = 0;
+    for (; last - first >= 8; first += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        int     mask = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(x, needle)));
+        n += lane_count(mask);
+    }
+    return n + count_scalar(first, last, v);
+}
+
+__attribute__((target("avx2"))) inline int
+min_avx2(const int* first, const int* last) {
+    if (last - first < 8) return min_scalar(first, last);
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    for (first += 8; last - first >= 8; first += 8) {
+        acc = _mm256_min_epi32(
+            acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int m = reduce_min(lanes);
+    return first == last ? m : std::min(m, min_scalar(first, last));
+}
+
+__attribute__((target("avx2"))) inline int
+max_avx2(const int* first, const int* last) {
+    if (last - first < 8) return max_scalar(first, last);
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    for (first += 8; last - first >= 8; first += 8) {
+        acc = _mm256_max_epi32(
+            acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int m = reduce_max(lanes);
+    return first == last ? m : std::max(m, max_scalar(first, last));
+}
+
+// 每次取 4 个 int 符号扩展成 64 位再累加
+__attribute__((target("avx2"))) inline long long
+sum_avx2(const int* first, const int* last) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    for (; last - first >= 8; first += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        __m128i hi =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 4));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(lo));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(hi));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(
+        reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+    return reduce_sum<long long>(lanes) + sum_scalar(first, last);
+}
+
+// _mm256_mul_epi32 取每个 64 位通道的低 32 位做有符号乘法
+__attribute__((target("avx2"))) inline long long
+dot_avx2(const int* first, const int* last, const int* other) {
+    __m256i acc = _mm256_setzero_si256();
+    for (; last - first >= 4; first += 4, other += 4) {
+        __m256i a = _mm256_cvtepi32_epi64(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)));
+        __m256i b = _mm256_cvtepi32_epi64(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(other)));
+        acc = _mm256_add_epi64(acc, _mm256_mul_epi32(a, b));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return reduce_sum<long long>(lanes) + dot_scalar(first, last, other);
+}
+
+__attribute__((target("avx2"))) inline const float*
+find_avx2(const float* first, const float* last, float v) {
+    const __m256 needle = _mm256_set1_ps(v);
+    for (; last - first >= 8; first += 8) {
+        int mask = _mm256_movemask_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(first), needle, _CMP_EQ_OQ));
+        if (mask) return first + first_lane(mask);
+    }
+    return std::find(first, last, v);
+}
+
+__attribute__((target("avx2"))) inline size_t
+count_avx2(const float* first, const float* last, float v) {
+    const __m256 needle = _mm256_set1_ps(v);
+    size_t       n      = 0;
+    for (; last - first >= 8; first += 8) {
+        int mask = _mm256_movemask_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(first), needle, _CMP_EQ_OQ));
+        n += lane_count(mask);
+    }
+    return n + count_scalar(first, last, v);
+}
+
+__attribute__((target("avx2"))) inline float
+min_avx2(const float* first, const float* last) {
+    if (last - first < 8) return min_scalar(first, last);
+    __m256 acc = _mm256_loadu_ps(first);
+    for (first += 8; last - first >= 8; first += 8) {
+        acc = _mm256_min_ps(acc, _mm256_loadu_ps(first));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float m = reduce_min(lanes);
+    return first == last ? m : std::min(m, min_scalar(first, last));
+}
+
+__attribute__((target("avx2"))) inline float
+max_avx2(const float* first, const float* last) {
+    if (last - first < 8) return max_scalar(first, last);
+    __m256 acc = _mm256_loadu_ps(first);
+    for (first += 8; last - first >= 8; first += 8) {
+        acc = _mm256_max_ps(acc, _mm256_loadu_ps(first));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float m = reduce_max(lanes);
+    return first == last ? m : std::max(m, max_scalar(first, last));
+}
+
+__attribute__((target("avx2"))) inline float
+sum_avx2(const float* first, const float* last) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; last - first >= 16; first += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(first));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(first + 8));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    return reduce_sum<float>(lanes) + sum_scalar(first, last);
+}
+
+__attribute__((target("avx2"))) inline float
+dot_avx2(const float* first, const float* last, const float* other) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; last - first >= 16; first += 16, other += 16) {
+        acc0 = _mm256_add_ps(
+            acc0,
+            _mm256_mul_ps(_mm256_loadu_ps(first), _mm256_loadu_ps(other)));
+        acc1 = _mm256_add_ps(
+            acc1,
+            _mm256_mul_ps(
+                _mm256_loadu_ps(first + 8), _mm256_loadu_ps(other + 8)));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    return reduce_sum<float>(lanes) + dot_scalar(first, last, other);
+}
+
+/* ---------------- SSE4.2 ---------------- */
+
+__attribute__((target("sse4.2"))) inline const int*
+find_sse42(const int* first, const int* last, int v) {
+    const __m128i needle = _mm_set1_epi32(v);
+    for (; last - first >= 4; first += 4) {
+        __m128i x    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        int     mask =
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, needle)));
+        if (mask) return first + first_lane(mask);
+    }
+    return std::find(first, last, v);
+}
+
+__attribute__((target("sse4.2"))) inline size_t
+count_sse42(const int* first, const int* last, int v) {
+    const __m128i needle = _mm_set1_epi32(v);
+    size_t        n      = 0;
+    for (; last - first >= 4; first += 4) {
+        __m128i x    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        int     mask =
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, needle)));
+        n += lane_count(mask);
+    }
+    return n + count_scalar(first, last, v);
+}
+
+__attribute__((target("sse4.2"))) inline int
+min_sse42(const int* first, const int* last) {
+    if (last - first < 4) return min_scalar(first, last);
+    __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    for (first += 4; last - first >= 4; first += 4) {
+        acc = _mm_min_epi32(
+            acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    int m = reduce_min(lanes);
+    return first == last ? m : std::min(m, min_scalar(first, last));
+}
+
+__attribute__((target("sse4.2"))) inline int
+max_sse42(const int* first, const int* last) {
+    if (last - first < 4) return max_scalar(first, last);
+    __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    for (first += 4; last - first >= 4; first += 4) {
+        acc = _mm_max_epi32(
+            acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    int m = reduce_max(lanes);
+    return first == last ? m : std::max(m, max_scalar(first, last));
+}
+
+__attribute__((target("sse4.2"))) inline long long
+sum_sse42(const int* first, const int* last) {
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    for (; last - first >= 4; first += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        acc0      = _mm_add_epi64(acc0, _mm_cvtepi32_epi64(x));
+        acc1 = _mm_add_epi64(acc1, _mm_cvtepi32_epi64(_mm_srli_si128(x, 8)));
+    }
+    alignas(16) long long lanes[2];
+    _mm_store_si128(
+        reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(acc0, acc1));
+    return reduce_sum<long long>(lanes) + sum_scalar(first, last);
+}
+
+__attribute__((target("sse4.2"))) inline long long
+dot_sse42(const int* first, const int* last, const int* other) {
+    __m128i acc = _mm_setzero_si128();
+    for (; last - first >= 2; first += 2, other += 2) {
+        __m128i a = _mm_cvtepi32_epi64(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(first)));
+        __m128i b = _mm_cvtepi32_epi64(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(other)));
+        acc = _mm_add_epi64(acc, _mm_mul_epi32(a, b));
+    }
+    alignas(16) long long lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return reduce_sum<long long>(lanes) + dot_scalar(first, last, other);
+}
+
+__attribute__((target("sse4.2"))) inline const float*
+find_sse42(const float* first, const float* last, float v) {
+    const __m128 needle = _mm_set1_ps(v);
+    for (; last - first >= 4; first += 4) {
+        int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(first), needle));
+        if (mask) return first + first_lane(mask);
+    }
+    return std::find(first, last, v);
+}
+
+__attribute__((target("sse4.2"))) inline size_t
+count_sse42(const float* first, const float* last, float v) {
+    const __m128 needle = _mm_set1_ps(v);
+    size_t       n      = 0;
+    for (; last - first >= 4; first += 4) {
+        int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(first), needle));
+        n += lane_count(mask);
+    }
+    return n + count_scalar(first, last, v);
+}
+
+__attribute__((target("sse4.2"))) inline float
+min_sse42(const float* first, const float* last) {
+    if (last - first < 4) return min_scalar(first, last);
+    __m128 acc = _mm_loadu_ps(first);
+    for (first += 4; last - first >= 4; first += 4) {
+        acc = _mm_min_ps(acc, _mm_loadu_ps(first));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    float m = reduce_min(lanes);
+    return first == last ? m : std::min(m, min_scalar(first, last));
+}
+
+__attribute__((target("sse4.2"))) inline float
+max_sse42(const float* first, const float* last) {
+    if (last - first < 4) return max_scalar(first, last);
+    __m128 acc = _mm_loadu_ps(first);
+    for (first += 4; last - first >= 4; first += 4) {
+        acc = _mm_max_ps(acc, _mm_loadu_ps(first));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    float m = reduce_max(lanes);
+    return first == last ? m : std::max(m, max_scalar(first, last));
+}
+
+__attribute__((target("sse4.2"))) inline float
+sum_sse42(const float* first, const float* last) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; last - first >= 8; first += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_loadu_ps(first));
+        acc1 = _mm_add_ps(acc1, _mm_loadu_ps(first + 4));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    return reduce_sum<float>(lanes) + sum_scalar(first, last);
+}
+
+__attribute__((target("sse4.2"))) inline float
+dot_sse42(const float* first, const float* last, const float* other) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; last - first >= 8; first += 8, other += 8) {
+        acc0 = _mm_add_ps(
+            acc0, _mm_mul_ps(_mm_loadu_ps(first), _mm_loadu_ps(other)));
+        acc1 = _mm_add_ps(
+            acc1, _mm_mul_ps(_mm_loadu_ps(first + 4), _mm_loadu_ps(other + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    return reduce_sum<float>(lanes) + dot_scalar(first, last, other);
+}
+
+// int 与 float 的向量化内核表
+template<typename T> const Kernels<T>& vector_kernels(Isa isa) {
+    static const Kernels<T> avx2{
+        find_avx2, count_avx2, min_avx2, max_avx2, sum_avx2, dot_avx2};
+    static const Kernels<T> sse42{
+        find_sse42, count_sse42, min_sse42, max_sse42, sum_sse42, dot_sse42};
+    switch (isa) {
+    case Isa::AVX2: return avx2;
+    case Isa::SSE42: return sse42;
+    default: return scalar_kernels<T>();
+    }
+}
+
+#endif   // MYARRAY_SIMD_X86
+
+}   // namespace detail
+
+// 取得指定指令集的内核表；CPU 不支持时退回到能用的最高指令集
+template<typename T> const Kernels<T>& kernels(Isa isa = detect_isa()) {
+    if (!isa_supported(isa)) {
+        isa = detect_isa();
+    }
+#if MYARRAY_SIMD_X86
+    if constexpr (std::is_same_v<T, int> || std::is_same_v<T, float>) {
+        return detail::vector_kernels<T>(isa);
+    }
+#endif
+    return detail::scalar_kernels<T>();
+}
+
+template<typename T> const T* find(const T* first, const T* last, T value) {
+    return kernels<T>().find(first, last, value);
+}
+
+template<typename T> size_t count(const T* first, const T* last, T value) {
+    return kernels<T>().count(first, last, value);
+}
+
+template<typename T> T min(const T* first, const T* last) {
+    if (first == last) {
+        throw std::runtime_error("min of an empty range");
+    }
+    return kernels<T>().min(first, last);
+}
+
+template<typename T> T max(const T* first, const T* last) {
+    if (first == last) {
+        throw std::runtime_error("max of an empty range");
+    }
+    return kernels<T>().max(first, last);
+}
+
+template<typename T> sum_t<T> sum(const T* first, const T* last) {
+    return kernels<T>().sum(first, last);
+}
+
+// other 至少要有 last - first 个元素
+template<typename T>
+sum_t<T> dot(const T* first, const T* last, const T* other) {
+    return kernels<T>().dot(first, last, other);
+}
+
+template<typename T, size_t SIZE>
+const T* find(const MyArray<T, SIZE>& arr, T value) {
+    return find(arr.begin(), arr.end(), value);
+}
+
+template<typename T, size_t SIZE>
+size_t count(const MyArray<T, SIZE>& arr, T value) {
+    return count(arr.begin(), arr.end(), value);
+}
+
+template<typename T, size_t SIZE> T min(const MyArray<T, SIZE>& arr) {
+    return min(arr.begin(), arr.end());
+}
+
+template<typename T, size_t SIZE> T max(const MyArray<T, SIZE>& arr) {
+    return max(arr.begin(), arr.end());
+}
+
+template<typename T, size_t SIZE> sum_t<T> sum(const MyArray<T, SIZE>& arr) {
+    return sum(arr.begin(), arr.end());
+}
+
+template<typename T, size_t SIZE>
+sum_t<T> dot(const MyArray<T, SIZE>& a, const MyArray<T, SIZE>& b) {
+    if (a.size() != b.size()) {
+        throw std::runtime_error("dot of arrays with different sizes");
+    }
+    return dot(a.begin(), a.end(), b.begin());
+}
+
+}   // namespace simd
@@ -1,32 +1,131 @@
 #pragma once
+#include "NodePool.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <initializer_list>
-#include <iostream>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
+// 带哨兵的双向循环链表。节点通过裸指针互相链接，内存来自本链表的 NodePool，
+// push / pop 只需几次指针写入，没有引用计数。
+// splice / merge 会把其他链表的节点接过来，此时一并持有对方的内存池，
+// 保证这些节点所在的内存块比本链表活得久；池中的节点都释放后不再持有。
 template<typename T> class MyList {
+    struct NodeBase {
+        NodeBase *lst_, *nxt_;
+    };
+
+    struct Pool;
+
+    struct Node : NodeBase {
+        Pool *owner_;   // 分配这个节点的内存池
+        T     value_;
+        template<typename... Args>
+        explicit Node(Args &&...args)
+            : NodeBase{nullptr, nullptr}
+            , owner_(nullptr)
+            , value_(std::forward<Args>(args)...) {}
+    };
+
+    // 内存池和其中存活的节点数。节点可能被接到其他链表、在其他线程中释放，
+    // 所以计数是原子的；只有池的主人会往空闲链表里放节点
+    struct Pool {
+        Pool() : nodes(), live(0) {}
+
+        NodePool<Node>      nodes;
+        std::atomic<size_t> live;
+    };
+
+    template<bool IsConst> class IteratorImpl {
+        using node_ptr =
+            std::conditional_t<IsConst, const NodeBase *, NodeBase *>;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::conditional_t<IsConst, const T *, T *>;
+        using reference         = std::conditional_t<IsConst, const T &, T &>;
+
+        IteratorImpl() : ptr_(nullptr) {}
+        explicit IteratorImpl(node_ptr ptr) : ptr_(ptr) {}
+
+        // 普通迭代器可以隐式转换为常量迭代器
+        template<bool C = IsConst, typename = std::enable_if_t<C>>
+        IteratorImpl(const IteratorImpl<false> &other) : ptr_(other.ptr_) {}
+
+        IteratorImpl &operator++() {
+            ptr_ = ptr_->nxt_;
+            return *this;
+        }
+        IteratorImpl &operator--() {
+            ptr_ = ptr_->lst_;
+            return *this;
+        }
+        IteratorImpl operator++(int) {
+            IteratorImpl tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        IteratorImpl operator--(int) {
+            IteratorImpl tmp(*this);
+            --(*this);
+            return tmp;
+        }
+
+        bool operator==(const IteratorImpl &other) const {
+            return ptr_ == other.ptr_;
+        }
+        bool operator!=(const IteratorImpl &other) const {
+            return ptr_ != other.ptr_;
+        }
+        reference operator*() const { return value_of(ptr_); }
+        pointer   operator->() const { return &value_of(ptr_); }
+
+    private:
+        static reference value_of(node_ptr ptr) {
+            using node_t = std::conditional_t<IsConst, const Node *, Node *>;
+            return static_cast<node_t>(ptr)->value_;
+        }
+
+        node_ptr ptr_;
+
+        friend class MyList;
+        friend class IteratorImpl<!IsConst>;
+    };
+
 public:
-    MyList() : num_items_(0) {
-        puse_ = std::shared_ptr<Node>(new Node(0));
-        head_ = puse_;
-    }
+    using Iterator       = IteratorImpl<false>;
+    using ConstIterator  = IteratorImpl<true>;
+    using iterator       = Iterator;
+    using const_iterator = ConstIterator;
+
+    MyList()
+        : puse_{&puse_, &puse_}, num_items_(0), pool_(nullptr), borrowed_() {}
 
     explicit MyList(const std::initializer_list<T> &ilist) : MyList() {
-        if (ilist.size()) {
-            for (const auto &elm : ilist) {
-                push_back(elm);
-            }
+        for (const auto &elm : ilist) {
+            push_back(elm);
         }
     }
 
     explicit MyList(size_t n) : MyList() {
         while (n--) {
-            push_back(0);
+            emplace_back();
         }
     }
 
-    MyList(const MyList &other) { *this = other; }
+    MyList(const MyList &other) : MyList() {
+        for (const auto &elm : other) {
+            push_back(elm);
+        }
+    }
 
     MyList &operator=(const MyList &other) {
         if (this == &other) {
@@ -40,270 +139,418 @@ public:
         return *this;
     }
 
-    MyList(MyList &&other) noexcept : head_(other.head_), tail_(other.tail_) {
-    }
+    MyList(MyList &&other) noexcept : MyList() { take(other); }
 
     MyList &operator=(MyList &&other) noexcept {
         if (this != &other) {
             clear();
-            head_ = std::move(other.head_);
-            tail_ = std::move(other.tail_);
+            take(other);
         }
         return *this;
     }
     ~MyList() { clear(); }
 
-    void push_back(const T &elm) {
-        auto new_node = std::shared_ptr<Node>(new Node(elm));
-        BindNodes(new_node, puse_);
-        if (tail_ == nullptr) {
-            head_ = new_node;
-        } else {
-            BindNodes(tail_, new_node);
+    void push_back(const T &elm) { emplace_back(elm); }
+
+    void push_back(T &&elm) { emplace_back(std::move(elm)); }
+
+    void pop_back() {
+        if (!empty()) {
+            destroy(puse_.lst_);
         }
+    }
 
-        tail_ = new_node;
-        ++num_items_;
+    void push_front(const T &item) { emplace_front(item); }
+
+    void push_front(T &&item) { emplace_front(std::move(item)); }
+
+    void pop_front() {
+        if (!empty()) {
+            destroy(puse_.nxt_);
+        }
     }
 
-    void pop_back() {
-        if (tail_ != nullptr) {
-            if (tail_->lst_ != nullptr) {
-                tail_ = tail_->lst_;
-                tail_->nxt_.reset();
-                BindNodes(tail_, puse_);
-            } else {
-                tail_.reset();
-                head_ = tail_ = nullptr;
-            }
-            --num_items_;
+    void swap(MyList &other) noexcept {
+        if (this == &other) {
+            return;
+        }
+        MyList tmp(std::move(other));
+        other.take(*this);
+        take(tmp);
+    }
+
+    // 交换每个节点的前后指针，不移动元素
+    void reverse() noexcept {
+        NodeBase *node = &puse_;
+        do {
+            std::swap(node->lst_, node->nxt_);
+            node = node->lst_;
+        } while (node != &puse_);
+    }
+
+    // 把 other 的全部元素移到 pos 之前，O(1)
+    void splice(ConstIterator pos, MyList &other) {
+        if (this == &other || other.empty()) {
+            return;
         }
+        adopt_pools(other);
+        NodeBase *first = other.puse_.nxt_;
+        NodeBase *last  = other.puse_.lst_;
+        BindNodes(&other.puse_, &other.puse_);
+        link_range(node_of(pos), first, last);
+        num_items_ += other.num_items_;
+        other.num_items_ = 0;
+        other.borrowed_.clear();
     }
 
-    void push_front(const T &item) {
-        auto new_node = std::shared_ptr<Node>(new Node(item));
-        BindNodes(new_node, head_);
-        head_ = new_node;
-        if (tail_ == nullptr) {
-            BindNodes(head_, puse_);
-            tail_ = new_node;
+    void splice(ConstIterator pos, MyList &&other) { splice(pos, other); }
+
+    // 把 other 中 it 指向的元素移到 pos 之前，O(1)
+    void splice(ConstIterator pos, MyList &other, ConstIterator it) {
+        NodeBase *node  = node_of(it);
+        NodeBase *where = node_of(pos);
+        if (node == where || node->nxt_ == where) {
+            return;
         }
-        ++num_items_;
+        if (this != &other) {
+            adopt_pools(other);
+            --other.num_items_;
+            ++num_items_;
+        }
+        BindNodes(node->lst_, node->nxt_);
+        link_range(where, node, node);
     }
 
-    void pop_front() {
-        if (head_ != nullptr) {
-            if (head_->nxt_ != nullptr) {
-                head_ = head_->nxt_;
-                head_->lst_.reset();
-            } else {
-                head_.reset();
-                tail_.reset();
-            }
-            --num_items_;
+    void splice(ConstIterator pos, MyList &&other, ConstIterator it) {
+        splice(pos, other, it);
+    }
+
+    // 把 other 中 [first, last) 移到 pos 之前。
+    // 同一链表内为 O(1)，跨链表时需要 O(k) 统计移动的元素个数
+    void splice(
+        ConstIterator pos, MyList &other, ConstIterator first,
+        ConstIterator last) {
+        if (first == last) {
+            return;
         }
+        if (this != &other) {
+            size_t n = static_cast<size_t>(std::distance(first, last));
+            adopt_pools(other);
+            other.num_items_ -= n;
+            num_items_ += n;
+        }
+        NodeBase *head = node_of(first);
+        NodeBase *tail = node_of(last)->lst_;
+        BindNodes(head->lst_, node_of(last));
+        link_range(node_of(pos), head, tail);
     }
 
-    void swap(MyList &other) {
-        if (this == &other) {
+    void splice(
+        ConstIterator pos, MyList &&other, ConstIterator first,
+        ConstIterator last) {
+        splice(pos, other, first, last);
+    }
+
+    // 归并两个有序链表，只改链接；相等元素中本链表的排在前面
+    void merge(MyList &other) { merge(other, std::less<>()); }
+
+    void merge(MyList &&other) { merge(other, std::less<>()); }
+
+    template<typename Compare> void merge(MyList &other, Compare comp) {
+        if (this == &other || other.empty()) {
             return;
         }
-        std::swap(head_, other.head_);
-        std::swap(tail_, other.tail_);
-        std::swap(puse_, other.puse_);
+        adopt_pools(other);
+        relink(merge_chains(detach(), other.detach(), comp));
+        num_items_ += other.num_items_;
+        other.num_items_ = 0;
+        other.borrowed_.clear();
+    }
+
+    template<typename Compare> void merge(MyList &&other, Compare comp) {
+        merge(other, comp);
     }
 
-    void reverse() {
-        MyList tmp;
-        for (const auto &elm : *this) {
-            tmp.push_front(elm);
+    void sort() { sort(std::less<>()); }
+
+    // 自底向上的稳定归并排序，只改链接，不拷贝也不移动元素
+    template<typename Compare> void sort(Compare comp) {
+        if (num_items_ < 2) {
+            return;
+        }
+        constexpr size_t max_bins = 64;
+        NodeBase        *bins[max_bins] = {};
+        NodeBase        *chain          = detach();
+        while (chain) {
+            NodeBase *run = chain;
+            chain         = chain->nxt_;
+            run->nxt_     = nullptr;
+            // bins[i] 保存长度为 2^i 的有序段，且都比 run 中的元素靠前
+            size_t i = 0;
+            for (; i < max_bins - 1 && bins[i]; ++i) {
+                run     = merge_chains(bins[i], run, comp);
+                bins[i] = nullptr;
+            }
+            bins[i] = run;
+        }
+        NodeBase *result = nullptr;
+        for (NodeBase *bin : bins) {
+            if (bin) {
+                result = merge_chains(bin, result, comp);
+            }
         }
-        this->swap(tmp);
+        relink(result);
     }
 
     T &operator[](size_t pos) { return find(pos)->value_; }
 
+    const T &operator[](size_t pos) const { return find(pos)->value_; }
+
     bool empty() const { return num_items_ == 0; }
 
     size_t size() const { return num_items_; }
 
-    T &front() const {
-        if (head_ != nullptr) {
-            return head_->value_;
-        }
-        return puse_->value_;
+    T &front() {
+        check_not_empty();
+        return value(puse_.nxt_);
     }
 
-    T &back() const {
-        if (tail_ != nullptr) {
-            return tail_->value_;
-        }
-        return puse_->value_;
+    const T &front() const {
+        check_not_empty();
+        return value(puse_.nxt_);
+    }
+
+    T &back() {
+        check_not_empty();
+        return value(puse_.lst_);
+    }
+
+    const T &back() const {
+        check_not_empty();
+        return value(puse_.lst_);
     }
 
+    // 借来的内存池随之放开，自己的内存池留着复用
     void clear() {
-        while (tail_ != nullptr) {
-            pop_back();
+        while (!empty()) {
+            destroy(puse_.lst_);
         }
+        borrowed_.clear();
     }
 
 private:
-    struct Node {
-        std::shared_ptr<Node> lst_, nxt_;
-        T                     value_;
-        template<typename U>
-        Node(U &&item) : value_(item), lst_(nullptr), nxt_(nullptr) {}
-    };
-    std::shared_ptr<Node> find(size_t pos) {
-        try {
-            if (pos >= num_items_) {
-                throw std::runtime_error(
-                    "The pos is larger than the number of items");
-            }
+    static T &value(NodeBase *node) {
+        return static_cast<Node *>(node)->value_;
+    }
+
+    static const T &value(const NodeBase *node) {
+        return static_cast<const Node *>(node)->value_;
+    }
+
+    void check_not_empty() const {
+        if (empty()) {
+            throw std::runtime_error("The list is empty");
+        }
+    }
 
-            if (pos == 0) {
-                return head_;
+    Node *find(size_t pos) const {
+        if (pos >= num_items_) {
+            throw std::runtime_error(
+                "The pos is larger than the number of items");
+        }
+
+        NodeBase *pNode     = puse_.nxt_;
+        auto      DisToTail = num_items_ - pos - 1;
+        if (DisToTail < pos) {
+            pNode = puse_.lst_;
+            while (DisToTail--) {
+                pNode = pNode->lst_;
             }
-            if (pos == num_items_ - 1) {
-                return tail_;
+        } else {
+            while (pos--) {
+                pNode = pNode->nxt_;
             }
+        }
+        return static_cast<Node *>(pNode);
+    }
 
-            auto DisToTail = num_items_ - pos - 1;
-            if (DisToTail < pos) {
-                auto pNode = tail_;
-                while (DisToTail--) {
-                    pNode = pNode->lst_;
-                }
-                return pNode;
-            } else {
-                auto pNode = head_;
-                while (pos--) {
-                    pNode = pNode->nxt_;
-                }
-                return pNode;
-            }
+    static void BindNodes(NodeBase *first, NodeBase *second) {
+        first->nxt_  = second;
+        second->lst_ = first;
+    }
 
-        } catch (const std::exception &e) {
-            std::cerr << e.what() << std::endl;
-        }
+    static NodeBase *node_of(ConstIterator it) {
+        return const_cast<NodeBase *>(it.ptr_);
     }
 
-    void BindNodes(std::shared_ptr<Node> first, std::shared_ptr<Node> second) {
-        if (first != nullptr) {
-            first->nxt_ = second;
-        }
+    // 把已经摘下的 [first, last] 接到 pos 之前
+    static void link_range(NodeBase *pos, NodeBase *first, NodeBase *last) {
+        BindNodes(pos->lst_, first);
+        BindNodes(last, pos);
+    }
 
-        if (second != nullptr) {
-            second->lst_ = first;
+    // 摘下全部节点，返回以 nullptr 结尾的单向链；num_items_ 由调用者维护
+    NodeBase *detach() noexcept {
+        if (empty()) {
+            return nullptr;
         }
+        NodeBase *first  = puse_.nxt_;
+        puse_.lst_->nxt_ = nullptr;
+        BindNodes(&puse_, &puse_);
+        return first;
     }
 
-    class Iterator {
-    public:
-        Iterator() : ptr_(nullptr) {}
-        explicit Iterator(std::shared_ptr<Node> ptr) : ptr_(ptr) {}
-        Iterator(const Iterator &other) { this->ptr_ = other.ptr_; }
-        Iterator(Iterator &&other) : ptr_(nullptr) {
-            std::swap(other.ptr_, this->ptr_);
-        }
-        Iterator &operator=(const Iterator &other) {
-            ptr_ = other.ptr_;
-            return *this;
+    // 把单向链重新挂回哨兵并补齐前驱指针
+    void relink(NodeBase *chain) noexcept {
+        NodeBase *prev = &puse_;
+        for (; chain; chain = chain->nxt_) {
+            BindNodes(prev, chain);
+            prev = chain;
         }
-        Iterator &operator=(Iterator &&other) {
-            ptr_       = other.ptr_;
-            other.ptr_ = nullptr;
-            return *this;
+        BindNodes(prev, &puse_);
+    }
+
+    // 归并两条以 nullptr 结尾的有序单向链，相等时 a 中的元素在前
+    template<typename Compare>
+    static NodeBase *merge_chains(NodeBase *a, NodeBase *b, Compare &comp) {
+        NodeBase  head{nullptr, nullptr};
+        NodeBase *tail = &head;
+        while (a && b) {
+            if (comp(value(b), value(a))) {
+                tail->nxt_ = b;
+                b          = b->nxt_;
+            } else {
+                tail->nxt_ = a;
+                a          = a->nxt_;
+            }
+            tail = tail->nxt_;
         }
-        Iterator &operator++() {
-            ptr_ = ptr_->nxt_;
-            return *this;
+        tail->nxt_ = a ? a : b;
+        return head.nxt_;
+    }
+
+    // 持有 other 的内存池，此后 other 的节点可以安全地留在本链表中。
+    // 顺便放开已经没有存活节点的内存池
+    void adopt_pools(const MyList &other) {
+        borrowed_.erase(
+            std::remove_if(
+                borrowed_.begin(), borrowed_.end(),
+                [](const std::shared_ptr<Pool> &pool) {
+                    return pool->live.load(std::memory_order_acquire) == 0;
+                }),
+            borrowed_.end());
+        auto adopt = [this](const std::shared_ptr<Pool> &pool) {
+            if (pool && pool != pool_
+                && std::find(borrowed_.begin(), borrowed_.end(), pool)
+                       == borrowed_.end()) {
+                borrowed_.push_back(pool);
+            }
+        };
+        adopt(other.pool_);
+        for (const auto &pool : other.borrowed_) {
+            adopt(pool);
         }
-        Iterator &operator--() {
-            ptr_ = ptr_->lst_;
-            return *this;
+    }
+
+    // 在 pos 之前构造一个新节点
+    template<typename... Args> NodeBase *create(NodeBase *pos, Args &&...args) {
+        if (!pool_) {
+            pool_ = std::make_shared<Pool>();
         }
-        Iterator operator++(int) {
-            Iterator tmp(*this);
-            ++(*this);
-            return *this;
+        void *mem = pool_->nodes.allocate();
+        Node *node;
+        try {
+            node = ::new (mem) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            pool_->nodes.deallocate(mem);
+            throw;
         }
-        Iterator operator--(int) {
-            Iterator tmp(*this);
-            --(*this);
-            return *this;
+        node->owner_ = pool_.get();
+        pool_->live.fetch_add(1, std::memory_order_relaxed);
+        BindNodes(pos->lst_, node);
+        BindNodes(node, pos);
+        ++num_items_;
+        return node;
+    }
+
+    // 摘下并析构 node，返回它的后继。自己的节点放回空闲链表；
+    // 借来的节点不复用，所在内存池的节点都释放后就不再持有它
+    NodeBase *destroy(NodeBase *node) noexcept {
+        NodeBase *next = node->nxt_;
+        BindNodes(node->lst_, next);
+        Node *n    = static_cast<Node *>(node);
+        Pool *pool = n->owner_;
+        n->~Node();
+        --num_items_;
+        if (pool == pool_.get()) {
+            pool->nodes.deallocate(n);
+            pool->live.fetch_sub(1, std::memory_order_relaxed);
+        } else if (pool->live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            release_borrowed(pool);
         }
+        return next;
+    }
 
-        ~Iterator() = default;
-        bool operator==(const Iterator &other) { return ptr_ == other.ptr_; }
-        bool operator!=(const Iterator &other) { return ptr_ != other.ptr_; }
-        T   &operator*() const { return ptr_->value_; }
-        std::shared_ptr<Node> ptr_;
-    };
+    void release_borrowed(Pool *pool) noexcept {
+        for (auto &p : borrowed_) {
+            if (p.get() == pool) {
+                p.swap(borrowed_.back());
+                borrowed_.pop_back();
+                return;
+            }
+        }
+    }
 
-    class ConstIterator : public Iterator {
-    public:
-        explicit ConstIterator(std::shared_ptr<Node> ptr) : Iterator(ptr) {}
-        const T &operator*() const { return this->ptr_->value_; }
-    };
+    // 接管 other 的全部节点和内存池，调用前本链表必须为空
+    void take(MyList &other) noexcept {
+        if (!other.empty()) {
+            BindNodes(&puse_, other.puse_.nxt_);
+            BindNodes(other.puse_.lst_, &puse_);
+            BindNodes(&other.puse_, &other.puse_);
+        }
+        num_items_       = other.num_items_;
+        other.num_items_ = 0;
+        pool_.swap(other.pool_);
+        borrowed_.swap(other.borrowed_);
+    }
 
 public:
-    Iterator      begin() { return Iterator(head_); }
-    Iterator      end() { return Iterator(puse_); }
-    ConstIterator begin() const { return ConstIterator(head_); }
-    ConstIterator end() const { return ConstIterator(puse_); }
-    ConstIterator cbegin() const { return ConstIterator(head_); }
-    ConstIterator cend() const { return ConstIterator(puse_); }
-    template<typename U> Iterator insert(U &&elm, Iterator pos) {
-        if (pos == begin()) {
-            push_front(elm);
-            return begin();
-        }
-        if (pos == end()) {
-            push_back(elm);
-            return --end();
-        }
-        auto new_node = std::shared_ptr<Node>(new Node(elm));
-        BindNodes(pos.ptr_->lst_, new_node);
-        BindNodes(new_node, pos.ptr_);
-        ++num_items_;
-        return --pos;
+    Iterator      begin() { return Iterator(puse_.nxt_); }
+    Iterator      end() { return Iterator(&puse_); }
+    ConstIterator begin() const { return ConstIterator(puse_.nxt_); }
+    ConstIterator end() const { return ConstIterator(&puse_); }
+    ConstIterator cbegin() const { return ConstIterator(puse_.nxt_); }
+    ConstIterator cend() const { return ConstIterator(&puse_); }
+
+    template<typename U> Iterator insert(U &&elm, ConstIterator pos) {
+        return emplace(pos, std::forward<U>(elm));
     }
 
+    // 在 pos 之前用 args 原地构造一个元素
     template<typename... Args>
     Iterator emplace(ConstIterator pos, Args &&...args) {
-        T args_data[sizeof...(Args)]{args...};
-        for (size_t i = 0; i < sizeof...(Args); i++) {
-            insert(args_data[i], pos);
-        }
-        return pos;
+        return Iterator(create(node_of(pos), std::forward<Args>(args)...));
     }
 
-    template<typename... Args> void emplace_back(Args &&...args) {
-        emplace(cend(), std::forward<Args>(args)...);
+    template<typename... Args> T &emplace_back(Args &&...args) {
+        return value(create(&puse_, std::forward<Args>(args)...));
     }
 
-    template<typename... Args> void emplace_front(Args &&...args) {
-        T args_data[sizeof...(Args)]{args...};
-        for (size_t i = sizeof...(Args); i-- > 0;) {
-            insert(args_data[i], begin());
-        }
+    template<typename... Args> T &emplace_front(Args &&...args) {
+        return value(create(puse_.nxt_, std::forward<Args>(args)...));
     }
 
-    void erase(Iterator pos) {
-        if (pos == begin()) {
-            pop_front();
-        } else if (pos == --end()) {
-            pop_back();
-        } else {
-            auto iter = pos.ptr_;
-            BindNodes(iter->lst_, iter->nxt_);
-            iter.reset();
-            --num_items_;
+    // 返回被删除元素的后继
+    Iterator erase(ConstIterator pos) {
+        if (pos == cend()) {
+            return end();
         }
+        return Iterator(destroy(const_cast<NodeBase *>(pos.ptr_)));
     }
 
 private:
-    size_t                num_items_ = 0;
-    std::shared_ptr<Node> head_, tail_, puse_;
+    NodeBase       puse_;
+    size_t         num_items_;
+    std::shared_ptr<Pool>              pool_;
+    std::vector<std::shared_ptr<Pool>> borrowed_;
 };
@@ -1,14 +1,33 @@
 #pragma once
 
 #include "MyList.hpp"
+#include "RingBuffer.hpp"
 
-template <typename T> class MyQueue {
+#include <type_traits>
+
+namespace queue_detail {
+// 容器自带批量操作（如 RingBuffer）时 push_range / pop_into 直接转发
+template <typename C, typename T, typename = void>
+struct has_bulk_ops : std::false_type {};
+
+template <typename C, typename T>
+struct has_bulk_ops<
+    C, T,
+    std::void_t<
+        decltype( std::declval<C &>().push_back_range(
+            std::declval<const T *>(), std::declval<const T *>() ) ),
+        decltype( std::declval<C &>().pop_front_into(
+            std::declval<T *>(), size_t() ) )>> : std::true_type {};
+} // namespace queue_detail
+
+// Container 需要提供与 MyList 相同的接口，例如 UnrolledList、RingBuffer
+template <typename T, typename Container = MyList<T>> class MyQueue {
 public:
-    MyQueue() = default;
+    MyQueue() : list_() {}
 
     explicit MyQueue( const std::initializer_list<T> &items ) : list_(items) {}
-    MyQueue( const MyQueue &other ) { *this = other; }
-    MyQueue( MyQueue &&other ) { *this = std::move( other ); }
+    MyQueue( const MyQueue &other ) : list_( other.list_ ) {}
+    MyQueue( MyQueue &&other ) : list_() { swap( other ); }
     ~MyQueue() = default;
 
     MyQueue &operator=( const MyQueue &other ) {
@@ -43,8 +62,38 @@ public:
 
     size_t size() const { return list_.size(); }
 
-    T &front() const { return list_.front(); }
+    T &front() { return list_.front(); }
+
+    const T &front() const { return list_.front(); }
+
+    // 批量入队 [first, last)
+    template <typename It> void push_range( It first, It last ) {
+        if constexpr ( queue_detail::has_bulk_ops<Container, T>::value ) {
+            list_.push_back_range( first, last );
+        } else {
+            for ( ; first != last; ++first ) {
+                list_.push_back( *first );
+            }
+        }
+    }
+
+    // 最多出队 n 个元素并按顺序写到 out，返回实际出队的个数
+    template <typename OutIt> size_t pop_into( OutIt out, size_t n ) {
+        if constexpr ( queue_detail::has_bulk_ops<Container, T>::value ) {
+            return list_.pop_front_into( out, n );
+        } else {
+            size_t moved = 0;
+            for ( ; moved < n && !list_.empty(); ++moved ) {
+                *out++ = std::move( list_.front() );
+                list_.pop_front();
+            }
+            return moved;
+        }
+    }
 
 private:
-    MyList<T> list_;
+    Container list_;
 };
+
+// 以连续环形缓冲区存储的队列，适合高频入队出队
+template <typename T> using RingQueue = MyQueue<T, RingBuffer<T>>;
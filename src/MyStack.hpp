@@ -1,13 +1,20 @@
 #pragma once
 
 #include "MyList.hpp"
+#include "SegmentedArray.hpp"
 
-template<typename T> class MyStack {
+// 栈顶在容器尾部。默认使用分段连续存储，压栈不会移动已有元素；
+// Container 也可以是 MyList、UnrolledList 等提供 push_back / pop_back / back 的容器
+template<typename T, typename Container = SegmentedArray<T>> class MyStack {
 public:
-    MyStack() = default;
-    explicit MyStack(const std::initializer_list<T> &items) { list_(items); }
-    MyStack(const MyStack &other) { *this = other; }
-    MyStack(MyStack &&other) { *this = std::move(other); }
+    MyStack() : list_() {}
+    explicit MyStack(const std::initializer_list<T> &items) : list_() {
+        for (const auto &item : items) {
+            list_.push_back(item);
+        }
+    }
+    MyStack(const MyStack &other) : list_(other.list_) {}
+    MyStack(MyStack &&other) : list_() { list_.swap(other.list_); }
 
     MyStack &operator=(const MyStack &other) {
         if (this != &other) {
@@ -27,21 +34,38 @@ public:
 
     size_t size() const { return list_.size(); }
 
-    void push(const T &value) { list_.push_front(value); }
+    void push(const T &value) { list_.push_back(value); }
 
-    void pop() { list_.pop_front(); }
+    void pop() { list_.pop_back(); }
 
     template<typename... Args> void emplace(Args &&...args) {
-        list_.emplace_front(std::forward<Args>(args)...);
+        list_.emplace_back(std::forward<Args>(args)...);
+    }
+
+    // 预留 n 个元素的空间，容器不支持时忽略
+    void reserve(size_t n) {
+        if constexpr (has_reserve<Container>::value) {
+            list_.reserve(n);
+        }
     }
 
     void swap(MyStack &other) {
         if (this == &other) return;
-        this->list_.Swap(other.list_);
+        this->list_.swap(other.list_);
     }
 
-    T &top() const { return list_.front(); }
+    T &top() { return list_.back(); }
+
+    const T &top() const { return list_.back(); }
 
 private:
-    MyList<T> list_;
+    template<typename C, typename = void>
+    struct has_reserve : std::false_type {};
+
+    template<typename C>
+    struct has_reserve<
+        C, std::void_t<decltype(std::declval<C &>().reserve(size_t()))>>
+        : std::true_type {};
+
+    Container list_;
 };
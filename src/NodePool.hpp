@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// 节点内存池：按块批量申请，释放的节点挂到空闲链表上复用。
+// 每个块的大小翻倍增长，直到 max_block 个节点。
+template<typename Node> class NodePool {
+    static constexpr size_t min_block = 16;
+    static constexpr size_t max_block = 4096;
+
+public:
+    NodePool()
+        : blocks_(), used_(0), free_(nullptr), next_(nullptr), end_(nullptr) {}
+
+    NodePool(const NodePool &)            = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    NodePool(NodePool &&other) noexcept
+        : blocks_(std::move(other.blocks_))
+        , used_(other.used_)
+        , free_(other.free_)
+        , next_(other.next_)
+        , end_(other.end_) {
+        other.blocks_.clear();
+        other.used_ = 0;
+        other.free_ = nullptr;
+        other.next_ = other.end_ = nullptr;
+    }
+
+    NodePool &operator=(NodePool &&other) noexcept {
+        if (this != &other) {
+            release();
+            blocks_ = std::move(other.blocks_);
+            used_   = other.used_;
+            free_   = other.free_;
+            next_   = other.next_;
+            end_    = other.end_;
+            other.blocks_.clear();
+            other.used_ = 0;
+            other.free_ = nullptr;
+            other.next_ = other.end_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~NodePool() { release(); }
+
+    // 返回一个未构造的节点
+    void *allocate() {
+        if (free_) {
+            FreeNode *p = free_;
+            free_       = p->next;
+            return p;
+        }
+        if (next_ == end_) {
+            grow();
+        }
+        return next_++;
+    }
+
+    // 节点必须已经析构
+    void deallocate(void *p) noexcept {
+        FreeNode *f = static_cast<FreeNode *>(p);
+        f->next     = free_;
+        free_       = f;
+    }
+
+    // 把所有节点一次性标记为空闲，已申请的块留着重新分配。
+    // 池中的节点必须已经析构或者无需析构
+    void reset() noexcept {
+        used_ = 0;
+        free_ = nullptr;
+        next_ = end_ = nullptr;
+    }
+
+    void swap(NodePool &other) noexcept {
+        std::swap(blocks_, other.blocks_);
+        std::swap(used_, other.used_);
+        std::swap(free_, other.free_);
+        std::swap(next_, other.next_);
+        std::swap(end_, other.end_);
+    }
+
+private:
+    struct FreeNode {
+        FreeNode *next;
+    };
+    static_assert(sizeof(Node) >= sizeof(FreeNode), "node is too small");
+
+    // reset 之后先依次复用已有的块
+    void grow() {
+        if (used_ == blocks_.size()) {
+            size_t n = blocks_.empty()
+                         ? min_block
+                         : std::min(blocks_.back().second * 2, max_block);
+            blocks_.reserve(blocks_.size() + 1);
+            blocks_.emplace_back(std::allocator<Node>().allocate(n), n);
+        }
+        auto &block = blocks_[used_++];
+        next_       = block.first;
+        end_        = block.first + block.second;
+    }
+
+    void release() noexcept {
+        for (auto &block : blocks_) {
+            std::allocator<Node>().deallocate(block.first, block.second);
+        }
+        blocks_.clear();
+        used_ = 0;
+        free_ = nullptr;
+        next_ = end_ = nullptr;
+    }
+
+    std::vector<std::pair<Node *, size_t>> blocks_;
+    size_t                                 used_;
+    FreeNode                              *free_;
+    Node                                  *next_, *end_;
+};
+
+// 树节点的分配策略，作为 Map / AVLMap 的模板参数。
+// Pool<Node> 提供 create / destroy / release；bulk_release 为 true 时
+// release 能一次性收回所有节点，无需逐个释放。
+
+// 每个节点单独 new / delete
+struct HeapNodes {
+    template<typename Node> class Pool {
+    public:
+        static constexpr bool bulk_release = false;
+
+        template<typename... Args> Node *create(Args &&...args) {
+            return new Node(std::forward<Args>(args)...);
+        }
+
+        void destroy(Node *node) noexcept { delete node; }
+
+        void release() noexcept {}
+
+        void swap(Pool &) noexcept {}
+    };
+};
+
+// 节点来自 NodePool 的连续块，释放的节点在池内复用；
+// release 之后块仍然保留，反复建树清空时不再向系统申请内存
+struct ArenaNodes {
+    template<typename Node> class Pool {
+    public:
+        static constexpr bool bulk_release = true;
+
+        Pool() : pool_() {}
+
+        template<typename... Args> Node *create(Args &&...args) {
+            void *p = pool_.allocate();
+            try {
+                return ::new (p) Node(std::forward<Args>(args)...);
+            } catch (...) {
+                pool_.deallocate(p);
+                throw;
+            }
+        }
+
+        void destroy(Node *node) noexcept {
+            node->~Node();
+            pool_.deallocate(node);
+        }
+
+        void release() noexcept { pool_.reset(); }
+
+        void swap(Pool &other) noexcept { pool_.swap(other.pool_); }
+
+    private:
+        NodePool<Node> pool_;
+    };
+};
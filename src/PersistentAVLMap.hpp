@@ -0,0 +1,315 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// 持久化（路径复制）的 AVL 树。节点带引用计数，多个版本共享没有改动的子树，
+// snapshot() 只是给根节点加一次引用，O(1)。
+// 修改时沿途只有被当前版本独占的节点才就地修改，被别的版本共享的节点先复制，
+// 所以没有快照时与普通的 AVL 树一样不复制，有快照时每次修改复制 O(log n) 个节点。
+// 同一个对象不能同时读写；不同的对象即使共享节点也可以在不同线程中随意使用，
+// 例如写线程修改自己的对象，把 snapshot() 交给其他线程无锁读取。
+template<typename Key, typename Value> class PersistentAVLMap {
+    struct Node {
+        Node(const Key& key, const Value& value)
+            : key(key)
+            , value(value)
+            , height(1)
+            , size(1)
+            , left(nullptr)
+            , right(nullptr)
+            , refs(1) {}
+
+        // 复制一个共享的节点，子树继续共享
+        explicit Node(const Node* other)
+            : key(other->key)
+            , value(other->value)
+            , height(other->height)
+            , size(other->size)
+            , left(retain(other->left))
+            , right(retain(other->right))
+            , refs(1) {}
+
+        Node(const Node&)            = delete;
+        Node& operator=(const Node&) = delete;
+
+        Key                 key;
+        Value               value;
+        int                 height;
+        size_t              size;
+        Node*               left;    // 每个子指针持有一次引用
+        Node*               right;
+        std::atomic<size_t> refs;
+    };
+
+public:
+    PersistentAVLMap() : root(nullptr) {}
+
+    // 拷贝只增加根节点的引用计数
+    PersistentAVLMap(const PersistentAVLMap& other)
+        : root(retain(other.root)) {}
+
+    PersistentAVLMap(PersistentAVLMap&& other) noexcept : root(other.root) {
+        other.root = nullptr;
+    }
+
+    PersistentAVLMap& operator=(const PersistentAVLMap& other) {
+        if (this != &other) {
+            Node* old = root;
+            root      = retain(other.root);
+            release(old);
+        }
+        return *this;
+    }
+
+    PersistentAVLMap& operator=(PersistentAVLMap&& other) noexcept {
+        if (this != &other) {
+            release(root);
+            root       = other.root;
+            other.root = nullptr;
+        }
+        return *this;
+    }
+
+    ~PersistentAVLMap() { release(root); }
+
+    // 当前版本的只读副本，之后对本对象的修改不会影响它
+    PersistentAVLMap snapshot() const { return *this; }
+
+    void put(const Key& key, const Value& value) {
+        root = insertNode(root, key, value);
+    }
+
+    const Value* get(const Key& key) const {
+        const Node* node = root;
+        while (node) {
+            if (key < node->key) {
+                node = node->left;
+            } else if (node->key < key) {
+                node = node->right;
+            } else {
+                return &node->value;
+            }
+        }
+        return nullptr;
+    }
+
+    // 键不存在时什么也不做，也不会复制路径
+    void remove(const Key& key) {
+        if (get(key)) {
+            root = deleteNode(root, key);
+        }
+    }
+
+    size_t size() const { return root ? root->size : 0; }
+
+    bool empty() const { return root == nullptr; }
+
+    void clear() {
+        release(root);
+        root = nullptr;
+    }
+
+    // 中序迭代器，栈里保存尚未访问的祖先，栈顶是当前节点。
+    // 迭代期间不能修改本对象，需要边改边读时先取 snapshot()
+    class Iterator {
+    public:
+        Iterator() : path() {}
+
+        const Node& operator*() const { return *path.back(); }
+
+        const Node* operator->() const { return path.back(); }
+
+        Iterator& operator++() {
+            const Node* node = path.back()->right;
+            path.pop_back();
+            pushLeftSpine(node);
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return current() == other.current();
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return current() != other.current();
+        }
+
+    private:
+        friend class PersistentAVLMap;
+
+        const Node* current() const {
+            return path.empty() ? nullptr : path.back();
+        }
+
+        void pushLeftSpine(const Node* node) {
+            for (; node; node = node->left) {
+                path.push_back(node);
+            }
+        }
+
+        std::vector<const Node*> path;
+    };
+
+    Iterator begin() const {
+        Iterator it;
+        it.pushLeftSpine(root);
+        return it;
+    }
+
+    Iterator end() const { return Iterator(); }
+
+    std::vector<std::pair<Key, Value>> inorder() const {
+        std::vector<std::pair<Key, Value>> res;
+        res.reserve(size());
+        for (auto it = begin(); it != end(); ++it) {
+            res.emplace_back(it->key, it->value);
+        }
+        return res;
+    }
+
+private:
+    Node* root;
+
+    static Node* retain(Node* node) {
+        if (node) {
+            node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        return node;
+    }
+
+    // 引用计数归零的节点释放后再放掉它对子节点的引用，用栈代替递归
+    static void release(Node* node) {
+        std::vector<Node*> stack;
+        while (node) {
+            if (node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                if (node->left) stack.push_back(node->left);
+                if (node->right) stack.push_back(node->right);
+                delete node;
+            }
+            if (stack.empty()) break;
+            node = stack.back();
+            stack.pop_back();
+        }
+    }
+
+    // 接过 node 的一次引用，返回可以就地修改的节点：只有这一次引用时就是
+    // node 本身，否则复制一份并放掉原节点的引用。
+    // 从独占的父节点一路走下来，引用计数为 1 就说明没有别的版本能看到它
+    static Node* unshare(Node* node) {
+        if (node->refs.load(std::memory_order_acquire) == 1) {
+            return node;
+        }
+        Node* copy = new Node(node);
+        release(node);
+        return copy;
+    }
+
+    static int getHeight(const Node* node) { return node ? node->height : 0; }
+
+    static size_t getSize(const Node* node) { return node ? node->size : 0; }
+
+    static int getBalance(const Node* node) {
+        return getHeight(node->left) - getHeight(node->right);
+    }
+
+    static void update(Node* node) {
+        node->height =
+            1 + std::max(getHeight(node->left), getHeight(node->right));
+        node->size = 1 + getSize(node->left) + getSize(node->right);
+    }
+
+    // 以下函数都接过参数的引用并返回新子树根的引用，参数必须已经可写
+
+    static Node* rightRotate(Node* y) {
+        Node* x = unshare(y->left);
+        y->left = x->right;
+        x->right = y;
+        update(y);
+        update(x);
+        return x;
+    }
+
+    static Node* leftRotate(Node* x) {
+        Node* y = unshare(x->right);
+        x->right = y->left;
+        y->left = x;
+        update(x);
+        update(y);
+        return y;
+    }
+
+    static Node* rebalance(Node* node) {
+        update(node);
+        int balance = getBalance(node);
+        if (balance > 1) {
+            if (getBalance(node->left) < 0) {
+                node->left = leftRotate(unshare(node->left));
+            }
+            return rightRotate(node);
+        }
+        if (balance < -1) {
+            if (getBalance(node->right) > 0) {
+                node->right = rightRotate(unshare(node->right));
+            }
+            return leftRotate(node);
+        }
+        return node;
+    }
+
+    static Node* insertNode(Node* node, const Key& key, const Value& value) {
+        if (!node) {
+            return new Node(key, value);
+        }
+        node = unshare(node);
+        if (key < node->key) {
+            node->left = insertNode(node->left, key, value);
+        } else if (node->key < key) {
+            node->right = insertNode(node->right, key, value);
+        } else {
+            node->value = value;
+            return node;
+        }
+        return rebalance(node);
+    }
+
+    // 摘下最小的节点放进 min，它的子指针已清空
+    static Node* removeMin(Node* node, Node*& min) {
+        node = unshare(node);
+        if (!node->left) {
+            Node* right = node->right;
+            node->right = nullptr;
+            min = node;
+            return right;
+        }
+        node->left = removeMin(node->left, min);
+        return rebalance(node);
+    }
+
+    // 调用方保证 key 存在
+    static Node* deleteNode(Node* node, const Key& key) {
+        node = unshare(node);
+        if (key < node->key) {
+            node->left = deleteNode(node->left, key);
+            return rebalance(node);
+        }
+        if (node->key < key) {
+            node->right = deleteNode(node->right, key);
+            return rebalance(node);
+        }
+        Node* left = node->left;
+        Node* right = node->right;
+        node->left = node->right = nullptr;
+        release(node);
+        if (!left || !right) {
+            return left ? left : right;
+        }
+        // 用右子树的最小节点接替被删节点的位置
+        Node* successor = nullptr;
+        Node* rest = removeMin(right, successor);
+        successor->left = left;
+        successor->right = rest;
+        return rebalance(successor);
+    }
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// 把元素从旧缓冲区搬到新缓冲区，供 MyArray、RingBuffer 扩容使用
+namespace relocation {
+
+// 可被 memcpy 整体搬迁的类型：搬迁后无需在旧地址调用析构函数。
+// 默认只覆盖平凡可复制的类型，其他类型（如 std::unique_ptr）可以自行特化。
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+template<typename T>
+inline constexpr bool is_nothrow_relocatable_v =
+    is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>;
+
+// 把 [src1, src1 + n1) 和 [src2, src2 + n2) 分别搬到未初始化的 dst1、dst2，
+// 成功后源段视为未初始化。与 std::move_if_noexcept 相同，移动可能抛出异常
+// 且可以拷贝时改为拷贝：中途失败时销毁已构造的目标元素，源元素保持原样。
+// 只能移动且移动会抛出的类型失败后，源元素处于被移动过的有效状态
+template<typename T>
+void relocate(
+    T *src1, size_t n1, T *dst1, T *src2, size_t n2,
+    T *dst2) noexcept(is_nothrow_relocatable_v<T>) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if (n1) {
+            std::memcpy(static_cast<void *>(dst1), src1, n1 * sizeof(T));
+        }
+        if (n2) {
+            std::memcpy(static_cast<void *>(dst2), src2, n2 * sizeof(T));
+        }
+    } else {
+        constexpr bool use_move = std::is_nothrow_move_constructible_v<T>
+                               || !std::is_copy_constructible_v<T>;
+        auto construct = [](T *src, size_t n, T *dst) {
+            if constexpr (use_move) {
+                std::uninitialized_move_n(src, n, dst);
+            } else {
+                std::uninitialized_copy_n(src, n, dst);
+            }
+        };
+        construct(src1, n1, dst1);
+        try {
+            construct(src2, n2, dst2);
+        } catch (...) {
+            std::destroy_n(dst1, n1);
+            throw;
+        }
+        std::destroy_n(src1, n1);
+        std::destroy_n(src2, n2);
+    }
+}
+
+template<typename T>
+void relocate(T *src, size_t n, T *dst) noexcept(is_nothrow_relocatable_v<T>) {
+    relocate(src, n, dst, src + n, 0, dst + n);
+}
+
+} // namespace relocation
@@ -0,0 +1,226 @@
+#pragma once
+#include "Relocate.hpp"
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// 可增长的环形缓冲区，容量总是 2 的幂，用掩码代替取模。
+// 提供 MyQueue 需要的 push_back / pop_front 接口，并支持批量入队出队。
+// 扩容会移动元素，之前取得的引用随之失效。
+template<typename T> class RingBuffer {
+    static constexpr size_t min_capacity = 8;
+
+public:
+    RingBuffer() : data_(nullptr), mask_(0), head_(0), num_items_(0) {}
+
+    explicit RingBuffer(const std::initializer_list<T> &ilist)
+        : RingBuffer() {
+        push_back_range(ilist.begin(), ilist.end());
+    }
+
+    RingBuffer(const RingBuffer &other) : RingBuffer() {
+        reserve(other.num_items_);
+        for (size_t i = 0; i < other.num_items_; ++i) {
+            ::new (static_cast<void *>(data_ + i)) T(other[i]);
+            ++num_items_;
+        }
+    }
+
+    RingBuffer &operator=(const RingBuffer &other) {
+        if (this != &other) {
+            RingBuffer tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    RingBuffer(RingBuffer &&other) noexcept : RingBuffer() { swap(other); }
+
+    RingBuffer &operator=(RingBuffer &&other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~RingBuffer() { release(); }
+
+    void swap(RingBuffer &other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(mask_, other.mask_);
+        std::swap(head_, other.head_);
+        std::swap(num_items_, other.num_items_);
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args> T &emplace_back(Args &&...args) {
+        if (num_items_ == capacity()) {
+            // 参数可能引用缓冲区内的元素，先构造再扩容
+            T value(std::forward<Args>(args)...);
+            reallocate(grow_capacity(num_items_ + 1));
+            return construct_back(std::move(value));
+        }
+        return construct_back(std::forward<Args>(args)...);
+    }
+
+    void pop_front() {
+        if (empty()) {
+            return;
+        }
+        std::destroy_at(data_ + head_);
+        head_ = (head_ + 1) & mask_;
+        --num_items_;
+    }
+
+    // 批量入队，前向迭代器最多扩容一次
+    template<typename It> void push_back_range(It first, It last) {
+        using category = typename std::iterator_traits<It>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+            const auto count = std::distance(first, last);
+            reserve(num_items_ + static_cast<size_t>(count));
+            // 空闲区最多分成缓冲区末尾和开头两段
+            while (first != last) {
+                size_t tail = (head_ + num_items_) & mask_;
+                size_t n    = std::min(
+                    capacity() - tail,
+                    static_cast<size_t>(std::distance(first, last)));
+                It mid = std::next(first, static_cast<std::ptrdiff_t>(n));
+                std::uninitialized_copy(first, mid, data_ + tail);
+                num_items_ += n;
+                first = mid;
+            }
+        } else {
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+    }
+
+    // 最多出队 n 个元素，按顺序移动到 out，返回实际出队的个数
+    template<typename OutIt> size_t pop_front_into(OutIt out, size_t n) {
+        n            = std::min(n, num_items_);
+        size_t moved = 0;
+        while (moved < n) {
+            size_t k = std::min(n - moved, capacity() - head_);
+            T     *p = data_ + head_;
+            out      = std::move(p, p + k, out);
+            std::destroy_n(p, k);
+            head_ = (head_ + k) & mask_;
+            num_items_ -= k;
+            moved += k;
+        }
+        return moved;
+    }
+
+    T &front() {
+        check_not_empty();
+        return data_[head_];
+    }
+
+    const T &front() const {
+        check_not_empty();
+        return data_[head_];
+    }
+
+    T &back() {
+        check_not_empty();
+        return data_[(head_ + num_items_ - 1) & mask_];
+    }
+
+    const T &back() const {
+        check_not_empty();
+        return data_[(head_ + num_items_ - 1) & mask_];
+    }
+
+    T &operator[](size_t idx) { return data_[(head_ + idx) & mask_]; }
+
+    const T &operator[](size_t idx) const {
+        return data_[(head_ + idx) & mask_];
+    }
+
+    bool empty() const noexcept { return num_items_ == 0; }
+
+    size_t size() const noexcept { return num_items_; }
+
+    size_t capacity() const noexcept { return data_ ? mask_ + 1 : 0; }
+
+    void reserve(size_t n) {
+        if (n > capacity()) {
+            reallocate(grow_capacity(n));
+        }
+    }
+
+    void clear() noexcept {
+        while (!empty()) {
+            pop_front();
+        }
+        head_ = 0;
+    }
+
+private:
+    void check_not_empty() const {
+        if (empty()) {
+            throw std::runtime_error("The queue is empty");
+        }
+    }
+
+    template<typename... Args> T &construct_back(Args &&...args) {
+        T *slot = data_ + ((head_ + num_items_) & mask_);
+        ::new (static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+        ++num_items_;
+        return *slot;
+    }
+
+    // 不小于 required 的最小 2 的幂
+    size_t grow_capacity(size_t required) const noexcept {
+        size_t cap = std::max(capacity() * 2, min_capacity);
+        while (cap < required) {
+            cap *= 2;
+        }
+        return cap;
+    }
+
+    // 搬到新缓冲区时顺便把环展开，队首落在下标 0。
+    // 搬迁失败时释放新缓冲区，原有元素保持不变
+    void reallocate(size_t new_cap) {
+        T     *new_data = std::allocator<T>().allocate(new_cap);
+        size_t first    = std::min(num_items_, capacity() - head_);
+        try {
+            relocation::relocate(
+                data_ + head_, first, new_data, data_, num_items_ - first,
+                new_data + first);
+        } catch (...) {
+            std::allocator<T>().deallocate(new_data, new_cap);
+            throw;
+        }
+        if (data_) {
+            std::allocator<T>().deallocate(data_, capacity());
+        }
+        data_ = new_data;
+        mask_ = new_cap - 1;
+        head_ = 0;
+    }
+
+    void release() noexcept {
+        clear();
+        if (data_) {
+            std::allocator<T>().deallocate(data_, capacity());
+        }
+        data_ = nullptr;
+        mask_ = 0;
+    }
+
+    T     *data_;
+    size_t mask_;
+    size_t head_;
+    size_t num_items_;
+};
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "MyArray.hpp"
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// 分段连续存储：第 k 段容纳 base << k 个元素，段一旦分配就不再移动，
+// 因此尾部增删不会使其余元素的引用失效。只在尾部增删，适合作为 MyStack 的容器。
+// 弹出后空出的段会保留下来供后续压入复用，shrink_to_fit 才归还。
+template<typename T> class SegmentedArray {
+    static constexpr size_t base =
+        sizeof(T) >= 32 ? 8 : 256 / sizeof(T);
+
+public:
+    SegmentedArray()
+        : segs_()
+        , used_(0)
+        , cur_(nullptr)
+        , seg_begin_(nullptr)
+        , seg_end_(nullptr)
+        , num_items_(0) {}
+
+    explicit SegmentedArray(const std::initializer_list<T> &ilist)
+        : SegmentedArray() {
+        reserve(ilist.size());
+        for (const auto &item : ilist) {
+            push_back(item);
+        }
+    }
+
+    SegmentedArray(const SegmentedArray &other) : SegmentedArray() {
+        reserve(other.num_items_);
+        for (size_t i = 0; i < other.num_items_; ++i) {
+            push_back(other[i]);
+        }
+    }
+
+    SegmentedArray &operator=(const SegmentedArray &other) {
+        if (this != &other) {
+            SegmentedArray tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    SegmentedArray(SegmentedArray &&other) noexcept : SegmentedArray() {
+        swap(other);
+    }
+
+    SegmentedArray &operator=(SegmentedArray &&other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~SegmentedArray() { release(); }
+
+    void swap(SegmentedArray &other) noexcept {
+        segs_.swap(other.segs_);
+        std::swap(used_, other.used_);
+        std::swap(cur_, other.cur_);
+        std::swap(seg_begin_, other.seg_begin_);
+        std::swap(seg_end_, other.seg_end_);
+        std::swap(num_items_, other.num_items_);
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args> T &emplace_back(Args &&...args) {
+        if (cur_ == seg_end_) {
+            next_segment();
+        }
+        try {
+            ::new (static_cast<void *>(cur_)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            // 刚切换到的新段仍是空的，退回上一段末尾，与 pop_back 保持一致
+            if (cur_ == seg_begin_ && used_ > 1) {
+                prev_segment();
+            }
+            throw;
+        }
+        ++num_items_;
+        return *cur_++;
+    }
+
+    void pop_back() {
+        if (empty()) {
+            return;
+        }
+        std::destroy_at(--cur_);
+        --num_items_;
+        if (cur_ == seg_begin_ && used_ > 1) {
+            prev_segment();
+        }
+    }
+
+    T &back() {
+        check_not_empty();
+        return cur_[-1];
+    }
+
+    const T &back() const {
+        check_not_empty();
+        return cur_[-1];
+    }
+
+    T &front() {
+        check_not_empty();
+        return segs_[0][0];
+    }
+
+    const T &front() const {
+        check_not_empty();
+        return segs_[0][0];
+    }
+
+    T &operator[](size_t idx) {
+        if (idx >= num_items_) {
+            throw std::runtime_error("The index is larger than size");
+        }
+        return at_unchecked(idx);
+    }
+
+    const T &operator[](size_t idx) const {
+        if (idx >= num_items_) {
+            throw std::runtime_error("The index is larger than size");
+        }
+        return const_cast<SegmentedArray *>(this)->at_unchecked(idx);
+    }
+
+    bool empty() const noexcept { return num_items_ == 0; }
+
+    size_t size() const noexcept { return num_items_; }
+
+    size_t capacity() const noexcept {
+        return base * ((size_t(1) << segs_.size()) - 1);
+    }
+
+    // 预先分配足够的段，之后压入 n 个元素以内不再分配内存
+    void reserve(size_t n) {
+        while (capacity() < n) {
+            allocate_segment();
+        }
+    }
+
+    // 归还当前未使用的段
+    void shrink_to_fit() {
+        while (segs_.size() > used_) {
+            deallocate_segment();
+        }
+    }
+
+    void clear() noexcept {
+        while (!empty()) {
+            pop_back();
+        }
+    }
+
+private:
+    static size_t segment_size(size_t k) noexcept { return base << k; }
+
+    // 下标 i 落在第 k 段，其中 k = floor(log2(i / base + 1))
+    T &at_unchecked(size_t idx) {
+        const size_t q = idx / base + 1;
+        const size_t k = static_cast<size_t>(63 - __builtin_clzll(q));
+        return segs_[k][idx - base * ((size_t(1) << k) - 1)];
+    }
+
+    void check_not_empty() const {
+        if (empty()) {
+            throw std::runtime_error("The stack is empty");
+        }
+    }
+
+    void allocate_segment() {
+        segs_.push_back(
+            std::allocator<T>().allocate(segment_size(segs_.size())));
+    }
+
+    void deallocate_segment() {
+        const size_t k = segs_.size() - 1;
+        std::allocator<T>().deallocate(segs_[k], segment_size(k));
+        segs_.pop_back();
+    }
+
+    void enter_segment(size_t k) {
+        seg_begin_ = segs_[k];
+        seg_end_   = seg_begin_ + segment_size(k);
+    }
+
+    void next_segment() {
+        if (used_ == segs_.size()) {
+            allocate_segment();
+        }
+        enter_segment(used_++);
+        cur_ = seg_begin_;
+    }
+
+    // 当前段已空，退回上一段的末尾
+    void prev_segment() {
+        --used_;
+        enter_segment(used_ - 1);
+        cur_ = seg_end_;
+    }
+
+    void release() noexcept {
+        clear();
+        used_ = 0;
+        cur_ = seg_begin_ = seg_end_ = nullptr;
+        shrink_to_fit();
+    }
+
+    MyArray<T *> segs_;
+    size_t       used_;
+    T           *cur_;
+    T           *seg_begin_;
+    T           *seg_end_;
+    size_t       num_items_;
+};
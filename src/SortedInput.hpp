@@ -0,0 +1,57 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 有序映射批量建树时对输入的预处理，输入元素为 (key, value) 对
+namespace sorted_input {
+
+// 键严格递增（有序且无重复）
+template<typename It> bool strictly_sorted(It first, It last) {
+    if (first == last) {
+        return true;
+    }
+    for (It prev = first++; first != last; prev = first++) {
+        if (!(prev->first < first->first)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 拷贝后按键稳定排序并去重；键相同时保留最后出现的值，与逐个插入的结果一致
+template<typename Key, typename T, typename It>
+std::vector<std::pair<Key, T>> sort_unique(It first, It last) {
+    std::vector<std::pair<Key, T>> items(first, last);
+    std::stable_sort(
+        items.begin(), items.end(),
+        [](const auto &a, const auto &b) { return a.first < b.first; });
+    size_t out = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (out > 0 && !(items[out - 1].first < items[i].first)) {
+            items[out - 1] = std::move(items[i]);
+        } else {
+            // 第一个重复键之前 out == i，自移动会清空 string、vector 等值
+            if (out != i) {
+                items[out] = std::move(items[i]);
+            }
+            ++out;
+        }
+    }
+    items.erase(items.begin() + static_cast<std::ptrdiff_t>(out), items.end());
+    return items;
+}
+
+// 能否不经拷贝直接在输入上建树：需要多遍访问且已经严格有序
+template<typename It> bool usable_in_place(It first, It last) {
+    using category = typename std::iterator_traits<It>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+        return strictly_sorted(first, last);
+    } else {
+        return false;
+    }
+}
+
+} // namespace sorted_input
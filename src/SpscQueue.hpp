@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+// 单生产者 / 单消费者的有界无锁队列，容量向上取整到 2 的幂。
+// push 系列只能由生产者线程调用，front / pop 系列只能由消费者线程调用，
+// 两端都不会阻塞：队列满时 push 返回 false，队列空时 front 返回 nullptr。
+// head 由消费者推进、tail 由生产者推进，都是不回绕的计数器，用掩码取下标。
+template<typename T> class SpscQueue {
+    static constexpr size_t cache_line = 64;
+
+public:
+    explicit SpscQueue(size_t capacity)
+        : mask_(round_up(capacity) - 1)
+        , data_(std::allocator<T>().allocate(mask_ + 1))
+        , consumer_()
+        , producer_() {}
+
+    SpscQueue(const SpscQueue &)            = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    ~SpscQueue() {
+        while (pop()) {
+        }
+        std::allocator<T>().deallocate(data_, mask_ + 1);
+    }
+
+    bool push(const T &value) { return emplace(value); }
+
+    bool push(T &&value) { return emplace(std::move(value)); }
+
+    template<typename... Args> bool emplace(Args &&...args) {
+        const size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (free_slots(tail) == 0) {
+            return false;
+        }
+        ::new (static_cast<void *>(data_ + (tail & mask_)))
+            T(std::forward<Args>(args)...);
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 尽量多地入队 [first, last)，只发布一次 tail，返回实际入队的个数
+    template<typename It> size_t push_range(It first, It last) {
+        const size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        const size_t room = free_slots(tail, capacity());
+        size_t       n    = 0;
+        try {
+            for (; n < room && first != last; ++n, ++first) {
+                ::new (static_cast<void *>(data_ + ((tail + n) & mask_)))
+                    T(*first);
+            }
+        } catch (...) {
+            // 已构造的元素照常发布
+            producer_.tail.store(tail + n, std::memory_order_release);
+            throw;
+        }
+        if (n) {
+            producer_.tail.store(tail + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // 队首元素，队列为空时返回 nullptr
+    T *front() {
+        const size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (used_slots(head) == 0) {
+            return nullptr;
+        }
+        return data_ + (head & mask_);
+    }
+
+    // 丢弃队首元素，队列为空时返回 false
+    bool pop() {
+        const size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (used_slots(head) == 0) {
+            return false;
+        }
+        std::destroy_at(data_ + (head & mask_));
+        consumer_.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 把队首元素移动到 out 后出队
+    bool pop(T &out) {
+        const size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (used_slots(head) == 0) {
+            return false;
+        }
+        T *slot = data_ + (head & mask_);
+        out     = std::move(*slot);
+        std::destroy_at(slot);
+        consumer_.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 最多出队 n 个元素写到 out，只发布一次 head，返回实际出队的个数
+    template<typename OutIt> size_t pop_into(OutIt out, size_t n) {
+        const size_t head = consumer_.head.load(std::memory_order_relaxed);
+        n                 = std::min(n, used_slots(head, n));
+        for (size_t i = 0; i < n; ++i) {
+            T *slot = data_ + ((head + i) & mask_);
+            *out++  = std::move(*slot);
+            std::destroy_at(slot);
+        }
+        if (n) {
+            consumer_.head.store(head + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // 另一端在并发修改时只是近似值
+    size_t size() const noexcept {
+        const size_t head = consumer_.head.load(std::memory_order_acquire);
+        const size_t tail = producer_.tail.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    size_t capacity() const noexcept { return mask_ + 1; }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t cap = 2;
+        while (cap < n) {
+            cap *= 2;
+        }
+        return cap;
+    }
+
+    // 生产者调用：先看缓存的 head，不够 wanted 个时才去读消费者的缓存行
+    size_t free_slots(size_t tail, size_t wanted = 1) {
+        size_t room = capacity() - (tail - producer_.cached_head);
+        if (room < wanted) {
+            producer_.cached_head =
+                consumer_.head.load(std::memory_order_acquire);
+            room = capacity() - (tail - producer_.cached_head);
+        }
+        return room;
+    }
+
+    // 消费者调用：先看缓存的 tail，不够 wanted 个时才去读生产者的缓存行
+    size_t used_slots(size_t head, size_t wanted = 1) {
+        size_t used = consumer_.cached_tail - head;
+        if (used < wanted) {
+            consumer_.cached_tail =
+                producer_.tail.load(std::memory_order_acquire);
+            used = consumer_.cached_tail - head;
+        }
+        return used;
+    }
+
+    // 两端各占一条缓存行，避免伪共享
+    struct alignas(cache_line) Consumer {
+        Consumer() : head(0), cached_tail(0) {}
+        std::atomic<size_t> head;
+        size_t              cached_tail;
+    };
+
+    struct alignas(cache_line) Producer {
+        Producer() : tail(0), cached_head(0) {}
+        std::atomic<size_t> tail;
+        size_t              cached_head;
+    };
+
+    const size_t mask_;
+    T *const     data_;
+    Consumer     consumer_;
+    Producer     producer_;
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "MpmcQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 分治算法用的固定大小线程池，任务放在 MpmcQueue 里。
+// fork_join 把第二个任务放进队列，当前线程执行第一个，然后一边等第二个
+// 完成一边帮忙执行队列里的任务。等待的线程不会闲着，嵌套的 fork_join
+// 也就不会因为所有工作线程都在等待而卡死。
+class ThreadPool {
+    static constexpr size_t queue_capacity = 1024;
+
+    // 任务对象放在发起 fork_join 的线程栈上，完成前它不会返回
+    struct Task {
+        template<typename F>
+        explicit Task(F &fn)
+            : invoke([](void *p) { (*static_cast<F *>(p))(); })
+            , fn(&fn)
+            , done(false)
+            , error() {}
+
+        Task(const Task &)            = delete;
+        Task &operator=(const Task &) = delete;
+
+        void run() noexcept {
+            try {
+                invoke(fn);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            done.store(true, std::memory_order_release);
+        }
+
+        void (*invoke)(void *);
+        void              *fn;
+        std::atomic<bool>  done;
+        std::exception_ptr error;
+    };
+
+public:
+    explicit ThreadPool(size_t workers) : queue_(queue_capacity), workers_() {
+        for (size_t i = 0; i < workers; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // 析构时不能还有进行中的 fork_join
+    ~ThreadPool() {
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            queue_.push(nullptr);
+        }
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // 全局共享的线程池，加上调用线程正好占满所有核，至少有一个工作线程
+    static ThreadPool &shared() {
+        static ThreadPool pool(
+            std::max(2u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    size_t size() const noexcept { return workers_.size(); }
+
+    // 并行执行 first 和 second，都完成后返回；任何一个抛出的异常在这里重新抛出
+    template<typename F, typename G> void fork_join(F &&first, G &&second) {
+        using Second = std::remove_reference_t<G>;
+        Task task(static_cast<Second &>(second));
+        if (workers_.empty() || !queue_.try_push(&task)) {
+            first();
+            second();
+            return;
+        }
+        std::exception_ptr error;
+        try {
+            first();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        while (!task.done.load(std::memory_order_acquire)) {
+            Task *other = nullptr;
+            if (queue_.try_pop(other) && other) {
+                other->run();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (task.error) {
+            std::rethrow_exception(task.error);
+        }
+    }
+
+private:
+    // 取到空指针时退出
+    void work() {
+        for (;;) {
+            Task *task = nullptr;
+            queue_.pop(task);
+            if (!task) {
+                return;
+            }
+            task->run();
+        }
+    }
+
+    MpmcQueue<Task *>        queue_;
+    std::vector<std::thread> workers_;
+};
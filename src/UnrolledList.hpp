@@ -0,0 +1,448 @@
+#pragma once
+#include "MyList.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// 每个节点默认存放约一条缓存行的元素，至少 4 个
+template<typename T>
+inline constexpr size_t unrolled_chunk_size =
+    sizeof(T) >= 16 ? 4 : 64 / sizeof(T);
+
+// 展开链表：每个节点保存一小段连续数组，接口与 MyList 相同，
+// 可以作为 MyQueue / MyStack 的底层容器。
+// 遍历时每个节点只需一次指针跳转，按下标访问一次跳过整个节点。
+// 在迭代器处插入 / 删除只移动同一节点内的至多 N 个元素；
+// 与 MyList 不同，插入和删除会使同一节点及被合并节点上的迭代器失效。
+template<typename T, size_t N = unrolled_chunk_size<T>> class UnrolledList {
+    static_assert(N >= 2, "a chunk must hold at least two elements");
+
+    struct ChunkBase {
+        ChunkBase *lst_, *nxt_;
+        size_t     count_;
+    };
+
+    struct Chunk : ChunkBase {
+        Chunk() : ChunkBase{nullptr, nullptr, 0} {}
+
+        T       *data() { return reinterpret_cast<T *>(storage_); }
+        const T *data() const { return reinterpret_cast<const T *>(storage_); }
+
+        alignas(T) unsigned char storage_[N * sizeof(T)];
+    };
+
+public:
+    UnrolledList() : puse_{&puse_, &puse_, 0}, num_items_(0), pool_() {}
+
+    explicit UnrolledList(const std::initializer_list<T> &ilist)
+        : UnrolledList() {
+        for (const auto &elm : ilist) {
+            push_back(elm);
+        }
+    }
+
+    explicit UnrolledList(size_t n) : UnrolledList() {
+        while (n--) {
+            emplace_back();
+        }
+    }
+
+    UnrolledList(const UnrolledList &other) : UnrolledList() {
+        for (const auto &elm : other) {
+            push_back(elm);
+        }
+    }
+
+    UnrolledList &operator=(const UnrolledList &other) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        for (const auto &elm : other) {
+            push_back(elm);
+        }
+        return *this;
+    }
+
+    UnrolledList(UnrolledList &&other) noexcept : UnrolledList() {
+        take(other);
+    }
+
+    UnrolledList &operator=(UnrolledList &&other) noexcept {
+        if (this != &other) {
+            clear();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~UnrolledList() { clear(); }
+
+    void push_back(const T &elm) { emplace_back(elm); }
+
+    void push_back(T &&elm) { emplace_back(std::move(elm)); }
+
+    void pop_back() {
+        if (empty()) {
+            return;
+        }
+        Chunk *last = chunk(puse_.lst_);
+        std::destroy_at(last->data() + --last->count_);
+        --num_items_;
+        if (last->count_ == 0) {
+            free_chunk(last);
+        }
+    }
+
+    void push_front(const T &item) { emplace_front(item); }
+
+    void push_front(T &&item) { emplace_front(std::move(item)); }
+
+    void pop_front() {
+        if (!empty()) {
+            erase(cbegin());
+        }
+    }
+
+    void swap(UnrolledList &other) noexcept {
+        if (this == &other) {
+            return;
+        }
+        UnrolledList tmp(std::move(other));
+        other.take(*this);
+        take(tmp);
+    }
+
+    // 翻转节点顺序并原地翻转每个节点内的数组
+    void reverse() {
+        ChunkBase *node = &puse_;
+        do {
+            std::swap(node->lst_, node->nxt_);
+            node = node->lst_;
+            if (node != &puse_) {
+                Chunk *c = chunk(node);
+                std::reverse(c->data(), c->data() + c->count_);
+            }
+        } while (node != &puse_);
+    }
+
+    T &operator[](size_t pos) {
+        auto [c, idx] = locate(pos);
+        return c->data()[idx];
+    }
+
+    const T &operator[](size_t pos) const {
+        auto [c, idx] = locate(pos);
+        return c->data()[idx];
+    }
+
+    bool empty() const { return num_items_ == 0; }
+
+    size_t size() const { return num_items_; }
+
+    T &front() {
+        check_not_empty();
+        return chunk(puse_.nxt_)->data()[0];
+    }
+
+    const T &front() const {
+        check_not_empty();
+        return chunk(puse_.nxt_)->data()[0];
+    }
+
+    T &back() {
+        check_not_empty();
+        Chunk *last = chunk(puse_.lst_);
+        return last->data()[last->count_ - 1];
+    }
+
+    const T &back() const {
+        check_not_empty();
+        const Chunk *last = chunk(puse_.lst_);
+        return last->data()[last->count_ - 1];
+    }
+
+    void clear() {
+        while (puse_.nxt_ != &puse_) {
+            Chunk *c = chunk(puse_.nxt_);
+            std::destroy_n(c->data(), c->count_);
+            num_items_ -= c->count_;
+            c->count_ = 0;
+            free_chunk(c);
+        }
+    }
+
+private:
+    static Chunk *chunk(ChunkBase *node) { return static_cast<Chunk *>(node); }
+
+    static const Chunk *chunk(const ChunkBase *node) {
+        return static_cast<const Chunk *>(node);
+    }
+
+    void check_not_empty() const {
+        if (empty()) {
+            throw std::runtime_error("The list is empty");
+        }
+    }
+
+    // 第 pos 个元素所在的节点和节点内下标，从离得近的一端开始数
+    std::pair<Chunk *, size_t> locate(size_t pos) const {
+        if (pos >= num_items_) {
+            throw std::runtime_error(
+                "The pos is larger than the number of items");
+        }
+        ChunkBase *node = const_cast<ChunkBase *>(&puse_);
+        if (pos < num_items_ / 2) {
+            node = node->nxt_;
+            while (pos >= node->count_) {
+                pos -= node->count_;
+                node = node->nxt_;
+            }
+        } else {
+            size_t from_end = num_items_ - pos;
+            node            = node->lst_;
+            while (from_end > node->count_) {
+                from_end -= node->count_;
+                node = node->lst_;
+            }
+            pos = node->count_ - from_end;
+        }
+        return {chunk(node), pos};
+    }
+
+    static void BindNodes(ChunkBase *first, ChunkBase *second) {
+        first->nxt_  = second;
+        second->lst_ = first;
+    }
+
+    // 在 pos 之前挂一个空节点
+    Chunk *new_chunk(ChunkBase *pos) {
+        Chunk *c = ::new (pool_.allocate()) Chunk();
+        BindNodes(pos->lst_, c);
+        BindNodes(c, pos);
+        return c;
+    }
+
+    void free_chunk(Chunk *c) noexcept {
+        BindNodes(c->lst_, c->nxt_);
+        c->~Chunk();
+        pool_.deallocate(c);
+    }
+
+    // 把 c 中 [from, count) 的元素搬到 dst 的末尾
+    static void move_tail(Chunk *c, size_t from, Chunk *dst) {
+        T     *src = c->data();
+        size_t n   = c->count_ - from;
+        std::uninitialized_move_n(src + from, n, dst->data() + dst->count_);
+        std::destroy_n(src + from, n);
+        dst->count_ += n;
+        c->count_ = from;
+    }
+
+    // 在节点 c 的下标 idx 处构造元素，c 必须还有空位
+    template<typename... Args> T *place(Chunk *c, size_t idx, Args &&...args) {
+        T *data = c->data();
+        if (idx == c->count_) {
+            ::new (static_cast<void *>(data + idx))
+                T(std::forward<Args>(args)...);
+        } else {
+            T value(std::forward<Args>(args)...);
+            ::new (static_cast<void *>(data + c->count_))
+                T(std::move(data[c->count_ - 1]));
+            std::move_backward(
+                data + idx, data + c->count_ - 1, data + c->count_);
+            data[idx] = std::move(value);
+        }
+        ++c->count_;
+        ++num_items_;
+        return data + idx;
+    }
+
+    // 在 (node, idx) 之前插入；节点满时对半分裂
+    template<typename... Args>
+    std::pair<Chunk *, size_t>
+    insert_at(ChunkBase *node, size_t idx, Args &&...args) {
+        if (node == &puse_) {
+            // 追加到末尾
+            Chunk *last = chunk(puse_.lst_);
+            if (last == &puse_ || last->count_ == N) {
+                last = new_chunk(&puse_);
+            }
+            size_t at = last->count_;
+            place(last, at, std::forward<Args>(args)...);
+            return {last, at};
+        }
+        Chunk *c = chunk(node);
+        if (c->count_ < N) {
+            place(c, idx, std::forward<Args>(args)...);
+            return {c, idx};
+        }
+        if (idx == 0 && c->lst_ != &puse_ && chunk(c->lst_)->count_ < N) {
+            // 插在节点开头时优先放进前一个节点的末尾
+            Chunk *prev = chunk(c->lst_);
+            size_t at   = prev->count_;
+            place(prev, at, std::forward<Args>(args)...);
+            return {prev, at};
+        }
+        // 分裂会移动元素，args 可能引用其中之一，先构造出新值
+        T      value(std::forward<Args>(args)...);
+        Chunk *next = new_chunk(c->nxt_);
+        move_tail(c, N / 2, next);
+        if (idx <= N / 2) {
+            place(c, idx, std::move(value));
+            return {c, idx};
+        }
+        place(next, idx - N / 2, std::move(value));
+        return {next, idx - N / 2};
+    }
+
+    // 删除 (c, idx)，节点过空时与后继合并；返回被删元素的后继位置
+    std::pair<ChunkBase *, size_t> erase_at(Chunk *c, size_t idx) {
+        T *data = c->data();
+        std::move(data + idx + 1, data + c->count_, data + idx);
+        std::destroy_at(data + --c->count_);
+        --num_items_;
+
+        if (c->count_ == 0) {
+            ChunkBase *next = c->nxt_;
+            free_chunk(c);
+            return {next, 0};
+        }
+        if (c->count_ < N / 2 && c->nxt_ != &puse_
+            && c->count_ + c->nxt_->count_ <= N) {
+            Chunk *next = chunk(c->nxt_);
+            move_tail(next, 0, c);
+            free_chunk(next);
+        }
+        if (idx == c->count_) {
+            return {c->nxt_, 0};
+        }
+        return {c, idx};
+    }
+
+    void take(UnrolledList &other) noexcept {
+        if (!other.empty()) {
+            BindNodes(&puse_, other.puse_.nxt_);
+            BindNodes(other.puse_.lst_, &puse_);
+            BindNodes(&other.puse_, &other.puse_);
+        }
+        num_items_       = other.num_items_;
+        other.num_items_ = 0;
+        pool_.swap(other.pool_);
+    }
+
+    template<bool IsConst> class IteratorImpl {
+        using node_ptr =
+            std::conditional_t<IsConst, const ChunkBase *, ChunkBase *>;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::conditional_t<IsConst, const T *, T *>;
+        using reference         = std::conditional_t<IsConst, const T &, T &>;
+
+        IteratorImpl() : node_(nullptr), idx_(0) {}
+        IteratorImpl(node_ptr node, size_t idx) : node_(node), idx_(idx) {}
+
+        template<bool C = IsConst, typename = std::enable_if_t<C>>
+        IteratorImpl(const IteratorImpl<false> &other)
+            : node_(other.node_), idx_(other.idx_) {}
+
+        IteratorImpl &operator++() {
+            if (++idx_ >= node_->count_) {
+                node_ = node_->nxt_;
+                idx_  = 0;
+            }
+            return *this;
+        }
+        IteratorImpl &operator--() {
+            if (idx_ == 0) {
+                node_ = node_->lst_;
+                idx_  = node_->count_;
+            }
+            --idx_;
+            return *this;
+        }
+        IteratorImpl operator++(int) {
+            IteratorImpl tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        IteratorImpl operator--(int) {
+            IteratorImpl tmp(*this);
+            --(*this);
+            return tmp;
+        }
+
+        bool operator==(const IteratorImpl &other) const {
+            return node_ == other.node_ && idx_ == other.idx_;
+        }
+        bool operator!=(const IteratorImpl &other) const {
+            return !(*this == other);
+        }
+        reference operator*() const { return chunk(node_)->data()[idx_]; }
+        pointer   operator->() const { return &**this; }
+
+    private:
+        node_ptr node_;
+        size_t   idx_;
+
+        friend class UnrolledList;
+        friend class IteratorImpl<!IsConst>;
+    };
+
+public:
+    using Iterator       = IteratorImpl<false>;
+    using ConstIterator  = IteratorImpl<true>;
+    using iterator       = Iterator;
+    using const_iterator = ConstIterator;
+
+    Iterator      begin() { return Iterator(puse_.nxt_, 0); }
+    Iterator      end() { return Iterator(&puse_, 0); }
+    ConstIterator begin() const { return ConstIterator(puse_.nxt_, 0); }
+    ConstIterator end() const { return ConstIterator(&puse_, 0); }
+    ConstIterator cbegin() const { return ConstIterator(puse_.nxt_, 0); }
+    ConstIterator cend() const { return ConstIterator(&puse_, 0); }
+
+    template<typename U> Iterator insert(U &&elm, ConstIterator pos) {
+        return emplace(pos, std::forward<U>(elm));
+    }
+
+    template<typename... Args>
+    Iterator emplace(ConstIterator pos, Args &&...args) {
+        ChunkBase *node = const_cast<ChunkBase *>(pos.node_);
+        auto [c, idx] =
+            insert_at(node, pos.idx_, std::forward<Args>(args)...);
+        return Iterator(c, idx);
+    }
+
+    template<typename... Args> T &emplace_back(Args &&...args) {
+        auto [c, idx] = insert_at(&puse_, 0, std::forward<Args>(args)...);
+        return c->data()[idx];
+    }
+
+    template<typename... Args> T &emplace_front(Args &&...args) {
+        auto [c, idx] = insert_at(puse_.nxt_, 0, std::forward<Args>(args)...);
+        return c->data()[idx];
+    }
+
+    Iterator erase(ConstIterator pos) {
+        if (pos == cend()) {
+            return end();
+        }
+        ChunkBase *node = const_cast<ChunkBase *>(pos.node_);
+        auto [next, idx] = erase_at(chunk(node), pos.idx_);
+        return Iterator(next, idx);
+    }
+
+private:
+    ChunkBase       puse_;
+    size_t          num_items_;
+    NodePool<Chunk> pool_;
+};
@@ -1,9 +1,41 @@
 #include <gtest/gtest.h>
 
 #include "../src/MyArray.hpp"
+#include "../src/MyArrayAlgorithm.hpp"
+#include "../src/AVLMap.hpp"
+#include "../src/AVLSetOps.hpp"
+#include "../src/BSTMap.hpp"
+#include "../src/BTree.hpp"
+#include "../src/CompactAVLMap.hpp"
+#include "../src/ConcurrentAVLMap.hpp"
+#include "../src/LockFreeStack.hpp"
+#include "../src/MappedArray.hpp"
+#include "../src/MpmcQueue.hpp"
+#include "../src/MyList.hpp"
+#include "../src/MyQueue.hpp"
+#include "../src/MyStack.hpp"
+#include "../src/PersistentAVLMap.hpp"
+#include "../src/SegmentedArray.hpp"
+#include "../src/SpscQueue.hpp"
+#include "../src/ThreadPool.hpp"
+#include "../src/UnrolledList.hpp"
 #include <gtest/gtest.h>
 #include <initializer_list>
+#include <list>
+#include <map>
+#include <mutex>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+#include <set>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 // 测试默认构造函数
 TEST(MyArrayTest, DefaultConstructor) {
@@ -72,6 +104,1938 @@ TEST(MyArrayTest, Swap) {
     }
 }
 
+// 测试追加时的几何扩容
+TEST(MyArrayTest, PushBackGrowth) {
+    MyArray<int> arr;
+    EXPECT_EQ(arr.capacity(), 0);
+
+    size_t reallocations = 0;
+    size_t last_capacity = arr.capacity();
+    for (int i = 0; i < 1000; ++i) {
+        arr.push_back(i);
+        if (arr.capacity() != last_capacity) {
+            ++reallocations;
+            last_capacity = arr.capacity();
+        }
+    }
+
+    EXPECT_EQ(arr.size(), 1000);
+    EXPECT_LE(reallocations, 11);
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_EQ(arr[i], static_cast<int>(i));
+    }
+}
+
+// 测试 reserve 与 shrink_to_fit
+TEST(MyArrayTest, ReserveAndShrink) {
+    MyArray<int> arr;
+    arr.reserve(64);
+    EXPECT_EQ(arr.capacity(), 64);
+    int *first = arr.begin();
+    for (int i = 0; i < 64; ++i) {
+        arr.emplace_back(i);
+    }
+    EXPECT_EQ(arr.begin(), first);   // reserve 之后追加不应重新分配
+
+    arr.remove(0);
+    arr.shrink_to_fit();
+    EXPECT_EQ(arr.capacity(), 63);
+    EXPECT_EQ(arr[0], 1);
+
+    arr.clear();
+    EXPECT_TRUE(arr.empty());
+    EXPECT_EQ(arr.capacity(), 63);
+    arr.shrink_to_fit();
+    EXPECT_EQ(arr.capacity(), 0);
+}
+
+// 测试按位置插入
+TEST(MyArrayTest, InsertAtPosition) {
+    MyArray<int> arr{1, 2, 4};
+    arr.insert(3, 2);
+    arr.insert(0, 0);
+    arr.insert(5, arr.size());
+
+    int expected[] = {0, 1, 2, 3, 4, 5};
+    ASSERT_EQ(arr.size(), 6);
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_EQ(arr[i], expected[i]);
+    }
+    EXPECT_THROW(arr.insert(7, 42), std::runtime_error);
+}
+
+namespace {
+// 没有默认构造函数，并统计拷贝/移动次数
+struct Tracked {
+    static int copies;
+    static int moves;
+    static int alive;
+
+    explicit Tracked(int v) : value(v) { ++alive; }
+    Tracked(const Tracked &other) : value(other.value) {
+        ++copies;
+        ++alive;
+    }
+    Tracked(Tracked &&other) noexcept : value(other.value) {
+        ++moves;
+        ++alive;
+    }
+    Tracked &operator=(const Tracked &other) {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    Tracked &operator=(Tracked &&other) noexcept {
+        value = other.value;
+        ++moves;
+        return *this;
+    }
+    ~Tracked() { --alive; }
+
+    int value;
+};
+int Tracked::copies = 0;
+int Tracked::moves  = 0;
+int Tracked::alive  = 0;
+}   // namespace
+
+// 测试无默认构造函数的类型，以及扩容时只移动不拷贝
+TEST(MyArrayTest, NonDefaultConstructible) {
+    Tracked::copies = Tracked::moves = 0;
+    {
+        MyArray<Tracked> arr;
+        for (int i = 0; i < 100; ++i) {
+            arr.emplace_back(i);
+        }
+        EXPECT_EQ(Tracked::copies, 0);
+        EXPECT_EQ(Tracked::alive, 100);
+
+        arr.insert(Tracked(-1), 50);
+        arr.remove(0);
+        EXPECT_EQ(arr[49].value, -1);
+        EXPECT_EQ(arr[50].value, 50);
+        EXPECT_EQ(Tracked::alive, 100);
+
+        MyArray<Tracked> copy(arr);
+        EXPECT_EQ(Tracked::copies, 100);
+        EXPECT_EQ(Tracked::alive, 200);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+// 测试非平凡类型的插入与删除
+TEST(MyArrayTest, NonTrivialElements) {
+    MyArray<std::string> arr{"b", "d"};
+    arr.insert(std::string("a"), 0);
+    arr.insert(std::string("c"), 2);
+    arr.push_back(arr[0]);   // 引用自身元素并触发扩容
+    arr.remove(1);
+
+    std::string expected[] = {"a", "c", "d", "a"};
+    ASSERT_EQ(arr.size(), 4);
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_EQ(arr[i], expected[i]);
+    }
+}
+
+namespace relocation {
+template<typename U>
+struct is_trivially_relocatable<std::unique_ptr<U>> : std::true_type {};
+}   // namespace relocation
+
+// 测试按位搬迁的 move-only 类型
+TEST(MyArrayTest, TriviallyRelocatable) {
+    MyArray<std::unique_ptr<int>> arr;
+    for (int i = 0; i < 10; ++i) {
+        arr.push_back(std::make_unique<int>(i));
+    }
+    arr.insert(std::make_unique<int>(42), 3);
+    arr.remove(0);
+    arr.shrink_to_fit();
+
+    ASSERT_EQ(arr.size(), 10);
+    EXPECT_EQ(*arr[2], 42);
+    EXPECT_EQ(*arr[3], 3);
+    EXPECT_EQ(*arr[9], 9);
+}
+
+namespace {
+// 移动构造可能抛出异常，拷贝构造在 budget 用完时抛出
+struct ThrowingCopy {
+    static int budget;
+
+    explicit ThrowingCopy(int v) : text(40, static_cast<char>('a' + v)) {}
+    ThrowingCopy(const ThrowingCopy &other) : text(other.text) {
+        if (budget-- == 0) {
+            throw std::runtime_error("copy");
+        }
+    }
+    ThrowingCopy(ThrowingCopy &&other) : text(std::move(other.text)) {}
+    ThrowingCopy &operator=(const ThrowingCopy &) = default;
+    ThrowingCopy &operator=(ThrowingCopy &&)      = default;
+
+    std::string text;
+};
+int ThrowingCopy::budget = -1;
+}   // namespace
+
+// 移动可能抛出时扩容改用拷贝，中途失败后数组保持原样（强异常保证）
+TEST(MyArrayTest, GrowthIsStrongWhenMoveMayThrow) {
+    MyArray<ThrowingCopy> arr;
+    for (int i = 0; i < 8; ++i) {
+        arr.emplace_back(i);
+    }
+    ASSERT_EQ(arr.size(), arr.capacity());
+    const size_t cap = arr.capacity();
+    auto check = [&] {
+        ASSERT_EQ(arr.size(), 8);
+        EXPECT_EQ(arr.capacity(), cap);
+        for (size_t i = 0; i < arr.size(); ++i) {
+            EXPECT_EQ(arr[i].text,
+                      std::string(40, static_cast<char>('a' + i)));
+        }
+    };
+
+    ThrowingCopy::budget = 3;
+    EXPECT_THROW(arr.emplace_back(8), std::runtime_error);
+    check();
+    ThrowingCopy::budget = 5;
+    EXPECT_THROW(arr.insert(ThrowingCopy(8), 2), std::runtime_error);
+    check();
+    ThrowingCopy extra[] = {ThrowingCopy(8), ThrowingCopy(9)};
+    ThrowingCopy::budget = 4;
+    EXPECT_THROW(arr.insert(arr.begin() + 4, extra, extra + 2),
+                 std::runtime_error);
+    check();
+    ThrowingCopy::budget = 6;
+    EXPECT_THROW(arr.reserve(64), std::runtime_error);
+    check();
+
+    ThrowingCopy::budget = -1;
+    arr.emplace_back(8);
+    EXPECT_EQ(arr.size(), 9);
+    EXPECT_EQ(arr[8].text, std::string(40, 'i'));
+}
+
+// 测试小缓冲区：SIZE 以内不分配堆内存
+TEST(MyArrayTest, InlineStorage) {
+    MyArray<int, 4> arr{1, 2};
+    EXPECT_FALSE(arr.on_heap());
+    EXPECT_EQ(arr.capacity(), 4);
+    arr.push_back(3);
+    arr.push_back(4);
+    EXPECT_FALSE(arr.on_heap());
+
+    arr.push_back(5);
+    EXPECT_TRUE(arr.on_heap());
+    EXPECT_EQ(arr.capacity(), 8);
+
+    arr.remove(4);
+    arr.shrink_to_fit();
+    EXPECT_FALSE(arr.on_heap());
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_EQ(arr[i], static_cast<int>(i + 1));
+    }
+}
+
+// 测试内联与堆上数组之间的移动和交换
+TEST(MyArrayTest, InlineMoveAndSwap) {
+    MyArray<std::string, 2> small{"a", "b"};
+    MyArray<std::string, 2> large{"x", "y", "z"};
+    EXPECT_FALSE(small.on_heap());
+    EXPECT_TRUE(large.on_heap());
+
+    small.swap(large);
+    ASSERT_EQ(small.size(), 3);
+    ASSERT_EQ(large.size(), 2);
+    EXPECT_EQ(small[2], "z");
+    EXPECT_EQ(large[1], "b");
+    EXPECT_FALSE(large.on_heap());
+
+    MyArray<std::string, 2> moved(std::move(large));
+    EXPECT_TRUE(large.empty());
+    EXPECT_FALSE(moved.on_heap());
+    EXPECT_EQ(moved[0], "a");
+
+    moved = std::move(small);
+    EXPECT_TRUE(moved.on_heap());
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_EQ(small.capacity(), 2);
+}
+
+// 测试每个可用指令集的批量算法与标量结果一致
+TEST(MyArraySimdTest, IntKernelsMatchScalar) {
+    std::mt19937                       rng(42);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+    const auto& scalar = simd::kernels<int>(simd::Isa::Scalar);
+
+    for (simd::Isa isa : {simd::Isa::SSE42, simd::Isa::AVX2}) {
+        if (!simd::isa_supported(isa)) continue;
+        const auto& k = simd::kernels<int>(isa);
+        for (size_t n = 1; n < 70; ++n) {
+            MyArray<int> a, b;
+            for (size_t i = 0; i < n; ++i) {
+                a.push_back(dist(rng));
+                b.push_back(dist(rng));
+            }
+            const int *first = a.begin(), *last = a.end();
+            int        needle = a[n / 2];
+            EXPECT_EQ(
+                k.find(first, last, needle), scalar.find(first, last, needle));
+            EXPECT_EQ(k.find(first, last, 5000), last);
+            EXPECT_EQ(
+                k.count(first, last, needle),
+                scalar.count(first, last, needle));
+            EXPECT_EQ(k.min(first, last), scalar.min(first, last));
+            EXPECT_EQ(k.max(first, last), scalar.max(first, last));
+            EXPECT_EQ(k.sum(first, last), scalar.sum(first, last));
+            EXPECT_EQ(
+                k.dot(first, last, b.begin()),
+                scalar.dot(first, last, b.begin()));
+        }
+    }
+}
+
+TEST(MyArraySimdTest, FloatKernelsMatchScalar) {
+    std::mt19937                          rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    const auto& scalar = simd::kernels<float>(simd::Isa::Scalar);
+
+    for (simd::Isa isa : {simd::Isa::SSE42, simd::Isa::AVX2}) {
+        if (!simd::isa_supported(isa)) continue;
+        const auto& k = simd::kernels<float>(isa);
+        for (size_t n = 1; n < 70; ++n) {
+            MyArray<float> a, b;
+            for (size_t i = 0; i < n; ++i) {
+                a.push_back(dist(rng));
+                b.push_back(dist(rng));
+            }
+            const float *first = a.begin(), *last = a.end();
+            float        needle = a[n - 1];
+            EXPECT_EQ(
+                k.find(first, last, needle), scalar.find(first, last, needle));
+            EXPECT_EQ(
+                k.count(first, last, needle),
+                scalar.count(first, last, needle));
+            EXPECT_EQ(k.min(first, last), scalar.min(first, last));
+            EXPECT_EQ(k.max(first, last), scalar.max(first, last));
+            // 累加顺序不同，只比较到舍入误差
+            EXPECT_NEAR(k.sum(first, last), scalar.sum(first, last), 1e-4);
+            EXPECT_NEAR(
+                k.dot(first, last, b.begin()),
+                scalar.dot(first, last, b.begin()), 1e-4);
+        }
+    }
+}
+
+// 测试 MyArray 重载与空区间
+TEST(MyArraySimdTest, ArrayOverloads) {
+    MyArray<int> a{3, -1, 4, 1, 5, 9, 2, 6, 5, 3};
+    MyArray<int> b{1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    EXPECT_EQ(simd::sum(a), 37);
+    EXPECT_EQ(simd::dot(a, b), 37);
+    EXPECT_EQ(simd::min(a), -1);
+    EXPECT_EQ(simd::max(a), 9);
+    EXPECT_EQ(simd::count(a, 5), 2);
+    EXPECT_EQ(simd::find(a, 9) - a.begin(), 5);
+
+    MyArray<int> empty;
+    EXPECT_EQ(simd::sum(empty), 0);
+    EXPECT_THROW(simd::min(empty), std::runtime_error);
+    EXPECT_THROW(simd::dot(a, empty), std::runtime_error);
+}
+
+// 测试区间插入：原地腾挪与一次扩容两种情况
+TEST(MyArrayTest, RangeInsert) {
+    MyArray<int> arr{1, 5};
+    arr.reserve(16);
+    int  mid[]  = {2, 3, 4};
+    int *before = arr.begin();
+    auto it     = arr.insert(arr.begin() + 1, mid, mid + 3);
+    EXPECT_EQ(arr.begin(), before);
+    EXPECT_EQ(*it, 2);
+
+    std::istringstream in("6 7 8");
+    arr.insert(
+        arr.end(),
+        std::istream_iterator<int>(in),
+        std::istream_iterator<int>());
+
+    MyArray<int> tail;
+    for (int i = 9; i <= 20; ++i) {
+        tail.push_back(i);
+    }
+    arr.insert(arr.end(), tail.begin(), tail.end());
+
+    ASSERT_EQ(arr.size(), 20);
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_EQ(arr[i], static_cast<int>(i + 1));
+    }
+
+    // SIZE 不为 0 时，单遍迭代器也只插入区间里的元素
+    MyArray<int, 3>    fixed{1, 2};
+    std::istringstream in2("7 8");
+    fixed.insert(
+        fixed.end(),
+        std::istream_iterator<int>(in2),
+        std::istream_iterator<int>());
+    int expected[] = {1, 2, 7, 8};
+    ASSERT_EQ(fixed.size(), 4);
+    for (size_t i = 0; i < fixed.size(); ++i) {
+        EXPECT_EQ(fixed[i], expected[i]);
+    }
+}
+
+TEST(MyArrayTest, RangeInsertNonTrivial) {
+    std::string          words[] = {"b", "c", "d"};
+    MyArray<std::string> arr{"a", "e", "f", "g", "h"};
+    arr.reserve(16);
+    arr.insert(arr.begin() + 1, words, words + 3);   // 插入点后元素多于 n
+    arr.insert(arr.end() - 1, words, words + 3);     // 插入点后元素少于 n
+
+    std::string expected[] = {
+        "a", "b", "c", "d", "e", "f", "g", "b", "c", "d", "h"};
+    ASSERT_EQ(arr.size(), 11);
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_EQ(arr[i], expected[i]);
+    }
+}
+
+// 测试区间删除与 erase_if
+TEST(MyArrayTest, RangeEraseAndEraseIf) {
+    MyArray<int> arr;
+    for (int i = 0; i < 100; ++i) {
+        arr.push_back(i);
+    }
+    int *data = arr.begin();
+    auto it   = arr.erase(arr.begin() + 10, arr.begin() + 20);
+    EXPECT_EQ(*it, 20);
+    EXPECT_EQ(arr.size(), 90);
+
+    size_t removed = arr.erase_if([](int x) { return x % 2 == 1; });
+    EXPECT_EQ(removed, 45);
+    EXPECT_EQ(arr.begin(), data);   // 不重新分配
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_EQ(arr[i] % 2, 0);
+    }
+    EXPECT_EQ(arr[5], 20);
+    EXPECT_THROW(arr.erase(arr.begin() + 1, arr.begin()), std::runtime_error);
+
+    MyArray<std::string> words{"x", "keep", "x", "x", "me"};
+    EXPECT_EQ(words.erase_if([](const std::string &w) { return w == "x"; }), 3);
+    words.erase(words.begin());
+    ASSERT_EQ(words.size(), 1);
+    EXPECT_EQ(words[0], "me");
+}
+
+namespace {
+struct Record {
+    int    id;
+    double score;
+};
+
+std::string temp_path(const char *name) {
+    return ::testing::TempDir() + name;
+}
+}   // namespace
+
+// 测试文件映射数组的写入、重新打开与只读模式
+TEST(MappedArrayTest, PersistAndReopen) {
+    const std::string path = temp_path("mapped_array_test.bin");
+    std::remove(path.c_str());
+    {
+        MappedArray<Record> arr(path, MappedArray<Record>::Mode::ReadWrite);
+        EXPECT_TRUE(arr.empty());
+        for (int i = 0; i < 10000; ++i) {
+            arr.push_back(Record{i, i * 0.5});
+        }
+        EXPECT_GE(arr.capacity(), 10000);
+        arr.flush();
+    }
+    {
+        MappedArray<Record> arr(path, MappedArray<Record>::Mode::ReadOnly);
+        arr.advise(MappedArray<Record>::Advice::Sequential);
+        ASSERT_EQ(arr.size(), 10000);
+        EXPECT_EQ(arr[9999].id, 9999);
+        EXPECT_DOUBLE_EQ(arr[42].score, 21.0);
+        EXPECT_THROW(arr.push_back(Record{0, 0}), std::runtime_error);
+        EXPECT_THROW(arr[10000], std::runtime_error);
+        // 映射没有写权限，写入不会被悄悄丢弃
+        EXPECT_DEATH(arr[0].id = 1, "");
+        EXPECT_DEATH(arr.begin()->score = 1.0, "");
+        EXPECT_EQ(arr[0].id, 0);
+    }
+    {
+        MappedArray<Record> arr(path, MappedArray<Record>::Mode::ReadWrite);
+        arr.emplace_back(Record{-1, -1.0});
+        arr.shrink_to_fit();
+        EXPECT_EQ(arr.capacity(), 10001);
+        EXPECT_EQ(arr[10000].id, -1);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(MappedArrayTest, RejectsForeignFiles) {
+    const std::string path = temp_path("mapped_array_foreign.bin");
+    std::remove(path.c_str());
+    {
+        MappedArray<int> arr(path, MappedArray<int>::Mode::ReadWrite);
+        arr.push_back(1);
+    }
+    using Mapped = MappedArray<double>;
+    EXPECT_THROW(Mapped(path, Mapped::Mode::ReadOnly), std::runtime_error);
+    std::remove(path.c_str());
+    EXPECT_THROW(Mapped(path, Mapped::Mode::ReadOnly), std::runtime_error);
+}
+
+// 测试链表的基本操作
+TEST(MyListTest, PushPopAndIterate) {
+    MyList<int> lst{2, 3};
+    lst.push_front(1);
+    lst.push_back(4);
+    lst.emplace_back(5);
+    EXPECT_EQ(lst.size(), 5);
+    EXPECT_EQ(lst.front(), 1);
+    EXPECT_EQ(lst.back(), 5);
+    EXPECT_EQ(lst[3], 4);
+
+    int expected = 1;
+    for (int x : lst) {
+        EXPECT_EQ(x, expected++);
+    }
+
+    lst.pop_front();
+    lst.pop_back();
+    auto it = lst.insert(10, ++lst.begin());
+    EXPECT_EQ(*it, 10);
+    it = lst.erase(it);
+    EXPECT_EQ(*it, 3);
+    EXPECT_EQ(lst.size(), 3);
+
+    lst.clear();
+    EXPECT_TRUE(lst.empty());
+    EXPECT_EQ(lst.begin(), lst.end());
+    EXPECT_THROW(lst.front(), std::runtime_error);
+}
+
+// 测试拷贝、移动与交换后节点和内存池仍然有效
+TEST(MyListTest, CopyMoveSwap) {
+    MyList<std::string> a{"a", "b", "c"};
+    MyList<std::string> b(a);
+    b.push_back("d");
+
+    MyList<std::string> c(std::move(b));
+    EXPECT_TRUE(b.empty());
+    EXPECT_EQ(c.size(), 4);
+    EXPECT_EQ(c.back(), "d");
+
+    a.swap(c);
+    EXPECT_EQ(a.size(), 4);
+    EXPECT_EQ(c.size(), 3);
+    a.pop_back();
+    c.push_back("x");
+    EXPECT_EQ(a.back(), "c");
+    EXPECT_EQ(c.back(), "x");
+
+    b = std::move(a);
+    b.reverse();
+    EXPECT_EQ(b.front(), "c");
+    EXPECT_EQ(b.back(), "a");
+}
+
+// 测试大量 push / pop 时节点被复用
+TEST(MyListTest, NodeReuse) {
+    MyList<int> lst;
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            lst.push_back(i);
+        }
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_EQ(lst.front(), i);
+            lst.pop_front();
+        }
+    }
+    EXPECT_TRUE(lst.empty());
+}
+
+TEST(MyQueueTest, FifoOrder) {
+    MyQueue<int> q;
+    for (int i = 0; i < 10; ++i) {
+        q.push(i);
+    }
+    q.emplace(10);
+    for (int i = 0; i <= 10; ++i) {
+        EXPECT_EQ(q.front(), i);
+        q.pop();
+    }
+    EXPECT_TRUE(q.empty());
+}
+
+// 队首绕回缓冲区开头后再扩容，顺序保持不变
+TEST(MyQueueTest, RingQueueWrapAndGrow) {
+    RingQueue<std::string> q;
+    std::list<std::string> ref;
+    for (int i = 0; i < 6; ++i) {
+        q.push(std::to_string(i));
+        ref.push_back(std::to_string(i));
+    }
+    for (int round = 0; round < 200; ++round) {
+        q.emplace(std::to_string(round));
+        ref.push_back(std::to_string(round));
+        if (round % 3 == 0) {
+            EXPECT_EQ(q.front(), ref.front());
+            q.pop();
+            ref.pop_front();
+        }
+    }
+    ASSERT_EQ(q.size(), ref.size());
+    RingQueue<std::string> copy(q);
+    for (const auto &s : ref) {
+        EXPECT_EQ(copy.front(), s);
+        copy.pop();
+    }
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(q.size(), ref.size());
+}
+
+// 扩容时拷贝失败，已绕回的环保持原样，新缓冲区被释放
+TEST(MyQueueTest, RingQueueGrowthIsStrong) {
+    RingQueue<ThrowingCopy> q;
+    for (int i = 0; i < 8; ++i) {
+        q.emplace(i);
+    }
+    for (int i = 0; i < 3; ++i) {
+        q.pop();
+        q.emplace(8 + i);
+    }
+    // 队首在下标 3，搬迁分成 5 个和 3 个两段，分别在两段中失败
+    for (int budget : {2, 6}) {
+        ThrowingCopy::budget = budget;
+        EXPECT_THROW(q.emplace(11), std::runtime_error);
+        ThrowingCopy::budget = -1;
+        ASSERT_EQ(q.size(), 8u);
+    }
+    q.emplace(11);
+    for (int i = 3; i <= 11; ++i) {
+        EXPECT_EQ(q.front().text, std::string(40, static_cast<char>('a' + i)));
+        q.pop();
+    }
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(MyQueueTest, BatchPushAndPop) {
+    RingQueue<int>   ring;
+    MyQueue<int>     list;
+    std::vector<int> in(100);
+    for (int i = 0; i < 100; ++i) {
+        in[static_cast<size_t>(i)] = i;
+    }
+    ring.push(-1);
+    ring.pop();
+    ring.push_range(in.begin(), in.end());
+    list.push_range(in.begin(), in.end());
+
+    std::vector<int> out(60, 0);
+    EXPECT_EQ(ring.pop_into(out.begin(), 60), 60u);
+    EXPECT_EQ(out[59], 59);
+    EXPECT_EQ(list.pop_into(out.begin(), 60), 60u);
+    EXPECT_EQ(out[0], 0);
+
+    // 环中剩 40 个，再追加 100 个使数据跨过缓冲区末尾
+    ring.push_range(in.begin(), in.end());
+    EXPECT_EQ(ring.pop_into(out.begin(), 60), 60u);
+    EXPECT_EQ(out[0], 60);
+    EXPECT_EQ(out[40], 0);
+    EXPECT_EQ(ring.size(), 80u);
+    EXPECT_EQ(list.pop_into(out.begin(), 60), 40u);
+    EXPECT_TRUE(list.empty());
+}
+
+TEST(SpscQueueTest, BoundedWrapAround) {
+    SpscQueue<std::string> q(5);
+    EXPECT_EQ(q.capacity(), 8u);
+    EXPECT_EQ(q.front(), nullptr);
+    EXPECT_FALSE(q.pop());
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 8; ++i) {
+            EXPECT_TRUE(q.push(std::to_string(i)));
+        }
+        EXPECT_FALSE(q.push("full"));
+        std::string s;
+        for (int i = 0; i < 5; ++i) {
+            EXPECT_TRUE(q.pop(s));
+            EXPECT_EQ(s, std::to_string(i));
+        }
+        std::vector<std::string> more{"a", "b", "c", "d"};
+        EXPECT_EQ(q.push_range(more.begin(), more.end()), 4u);
+        std::vector<std::string> out(8);
+        EXPECT_EQ(q.pop_into(out.begin(), 6), 6u);
+        EXPECT_EQ(out[0], "5");
+        EXPECT_EQ(out[3], "a");
+        EXPECT_EQ(out[5], "c");
+        EXPECT_TRUE(q.push("e"));
+        EXPECT_EQ(*q.front(), "d");
+        EXPECT_TRUE(q.pop());
+        EXPECT_TRUE(q.pop());
+        EXPECT_TRUE(q.empty());
+    }
+    // 析构时释放剩余元素
+    q.push("left");
+}
+
+// 生产者和消费者各一个线程，单个与批量操作混用，顺序必须保持
+TEST(SpscQueueTest, ConcurrentStress) {
+    const int      total = 200000;
+    SpscQueue<int> q(64);
+    std::thread    producer([&] {
+        int              next = 0;
+        std::vector<int> batch(16);
+        while (next < total) {
+            int before = next;
+            if (next % 3 == 0) {
+                int n = std::min(16, total - next);
+                for (int i = 0; i < n; ++i) {
+                    batch[static_cast<size_t>(i)] = next + i;
+                }
+                next += static_cast<int>(
+                    q.push_range(batch.begin(), batch.begin() + n));
+            } else if (q.push(next)) {
+                ++next;
+            }
+            if (next == before) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int              expect = 0;
+    bool             ok     = true;
+    std::vector<int> out(16);
+    while (expect < total) {
+        int before = expect;
+        if (expect % 2 == 0) {
+            size_t n = q.pop_into(out.begin(), out.size());
+            for (size_t i = 0; i < n; ++i) {
+                ok = ok && out[i] == expect++;
+            }
+        } else if (int *p = q.front()) {
+            ok = ok && *p == expect++;
+            q.pop();
+        }
+        if (expect == before) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ok);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(MpmcQueueTest, TryAndTimedOperations) {
+    MpmcQueue<std::string> q(3);
+    EXPECT_EQ(q.capacity(), 4u);
+    std::string s;
+    EXPECT_FALSE(q.try_pop(s));
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(q.try_push(std::to_string(i)));
+    }
+    EXPECT_FALSE(q.try_push("full"));
+    EXPECT_FALSE(q.try_push_for("full", std::chrono::milliseconds(5)));
+    EXPECT_EQ(q.size(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(q.try_pop_for(s, std::chrono::milliseconds(5)));
+        EXPECT_EQ(s, std::to_string(i));
+    }
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(q.try_pop_until(s, start + std::chrono::milliseconds(5)));
+    EXPECT_GE(
+        std::chrono::steady_clock::now() - start,
+        std::chrono::milliseconds(5));
+    // 析构时释放剩余元素
+    q.push("left");
+}
+
+// 多个生产者、多个消费者使用阻塞接口，容量很小以触发挂起；
+// 每个元素恰好被取出一次，同一生产者的元素在每个消费者看来保持顺序
+TEST(MpmcQueueTest, ConcurrentStress) {
+    const int                producers = 3, consumers = 3, per = 20000;
+    MpmcQueue<int>           q(8);
+    std::vector<std::thread> threads;
+    std::atomic<long long>   sum(0);
+    std::atomic<bool>        ordered(true);
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < per; ++i) {
+                q.push(p * per + i);
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            std::vector<int> last(producers, -1);
+            long long        local = 0;
+            for (int i = 0; i < producers * per / consumers; ++i) {
+                int v = 0;
+                q.pop(v);
+                local += v;
+                auto &prev = last[static_cast<size_t>(v / per)];
+                if (v <= prev) {
+                    ordered = false;
+                }
+                prev = v;
+            }
+            sum += local;
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    const long long n = producers * per;
+    EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+    EXPECT_TRUE(ordered.load());
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(MyStackTest, LifoOrder) {
+    MyStack<int> st{1, 2, 3};
+    st.push(4);
+    st.emplace(5);
+    for (int i = 5; i >= 1; --i) {
+        EXPECT_EQ(st.top(), i);
+        st.pop();
+    }
+    EXPECT_TRUE(st.empty());
+}
+
+// 跨段增删时已有元素的地址保持不变
+TEST(MyStackTest, SegmentedStorageKeepsReferences) {
+    SegmentedArray<std::string> arr;
+    arr.push_back("first");
+    const std::string *first = &arr.back();
+    for (int i = 1; i < 5000; ++i) {
+        arr.emplace_back(std::to_string(i));
+    }
+    EXPECT_EQ(first, &arr.front());
+    EXPECT_EQ(arr[0], "first");
+    EXPECT_EQ(arr[4321], "4321");
+    EXPECT_THROW(arr[5000], std::runtime_error);
+
+    const size_t cap = arr.capacity();
+    for (int i = 0; i < 4990; ++i) {
+        arr.pop_back();
+    }
+    EXPECT_EQ(arr.back(), "9");
+    EXPECT_EQ(arr.capacity(), cap);
+    arr.shrink_to_fit();
+    EXPECT_LT(arr.capacity(), cap);
+    EXPECT_EQ(first, &arr.front());
+
+    SegmentedArray<std::string> copy(arr);
+    EXPECT_EQ(copy.size(), 10u);
+    EXPECT_EQ(copy.back(), "9");
+
+    MyStack<int> st;
+    st.reserve(1000);
+    int *bottom = nullptr;
+    for (int i = 0; i < 1000; ++i) {
+        st.push(i);
+        if (i == 0) {
+            bottom = &st.top();
+        }
+    }
+    EXPECT_EQ(*bottom, 0);
+    EXPECT_EQ(st.top(), 999);
+}
+
+namespace {
+// 值为负时构造函数抛出异常
+struct ThrowIfNegative {
+    explicit ThrowIfNegative(int v) : value(v) {
+        if (v < 0) {
+            throw std::runtime_error("negative");
+        }
+    }
+
+    int value;
+};
+}   // namespace
+
+// 新段的第一个元素构造失败时，尾部仍停在上一段的末尾
+TEST(MyStackTest, SegmentedEmplaceThrowsAtSegmentBoundary) {
+    SegmentedArray<ThrowIfNegative> arr;
+    arr.emplace_back(0);
+    const size_t first_segment = arr.capacity();
+    for (int i = 1; arr.size() < first_segment; ++i) {
+        arr.emplace_back(i);
+    }
+    EXPECT_THROW(arr.emplace_back(-1), std::runtime_error);
+    EXPECT_EQ(arr.size(), first_segment);
+    EXPECT_EQ(arr.back().value, static_cast<int>(first_segment) - 1);
+    arr.pop_back();
+    EXPECT_EQ(arr.back().value, static_cast<int>(first_segment) - 2);
+
+    arr.emplace_back(100);
+    arr.emplace_back(101);
+    EXPECT_EQ(arr.back().value, 101);
+    EXPECT_EQ(arr[first_segment].value, 101);
+}
+
+TEST(LockFreeStackTest, LifoOrder) {
+    LockFreeStack<std::string> st;
+    std::string                s;
+    EXPECT_FALSE(st.try_pop(s));
+    st.push("a");
+    st.emplace(3, 'b');
+    EXPECT_TRUE(st.try_pop(s));
+    EXPECT_EQ(s, "bbb");
+    EXPECT_TRUE(st.try_pop(s));
+    EXPECT_EQ(s, "a");
+    EXPECT_TRUE(st.empty());
+    // 析构时释放剩余节点
+    st.push("left");
+}
+
+// 多个线程交替压栈出栈，每个值恰好出栈一次
+template<typename Stack> void lock_free_stack_stress() {
+    const int                threads = 4, per = 20000;
+    Stack                    st;
+    std::vector<int>         seen(threads * per, 0);
+    std::vector<std::thread> pool;
+    std::atomic<int>         popped(0);
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            std::vector<int> mine;
+            for (int i = 0; i < per; ++i) {
+                st.push(t * per + i);
+                int v = 0;
+                if (i % 2 && st.try_pop(v)) {
+                    mine.push_back(v);
+                }
+            }
+            int v = 0;
+            while (st.try_pop(v)) {
+                mine.push_back(v);
+            }
+            for (int x : mine) {
+                ++seen[static_cast<size_t>(x)];
+            }
+            popped += static_cast<int>(mine.size());
+        });
+    }
+    for (auto &th : pool) {
+        th.join();
+    }
+    EXPECT_EQ(popped.load(), threads * per);
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](int c) {
+        return c == 1;
+    }));
+}
+
+TEST(LockFreeStackTest, ConcurrentStress) {
+    lock_free_stack_stress<LockFreeStack<int>>();
+}
+
+TEST(LockFreeStackTest, ConcurrentStressWithElimination) {
+    lock_free_stack_stress<LockFreeStack<int, true>>();
+}
+
+// 随机插入 / 删除，与 std::list 的结果对照
+TEST(UnrolledListTest, MatchesStdList) {
+    UnrolledList<int, 4> lst;
+    std::list<int>       ref;
+    std::mt19937         rng(3);
+    for (int step = 0; step < 5000; ++step) {
+        size_t pos = ref.empty() ? 0 : rng() % (ref.size() + 1);
+        auto   it  = lst.begin();
+        auto   rit = ref.begin();
+        std::advance(it, static_cast<long>(pos));
+        std::advance(rit, static_cast<long>(pos));
+        switch (rng() % 5) {
+        case 0:
+        case 1:
+            it  = lst.insert(step, it);
+            rit = ref.insert(rit, step);
+            EXPECT_EQ(*it, *rit);
+            break;
+        case 2:
+            if (rit != ref.end()) {
+                it  = lst.erase(it);
+                rit = ref.erase(rit);
+                EXPECT_EQ(it == lst.end(), rit == ref.end());
+            }
+            break;
+        case 3:
+            lst.push_front(-step);
+            ref.push_front(-step);
+            break;
+        default:
+            if (!ref.empty()) {
+                lst.pop_back();
+                ref.pop_back();
+            }
+        }
+        ASSERT_EQ(lst.size(), ref.size());
+    }
+    EXPECT_TRUE(std::equal(lst.begin(), lst.end(), ref.begin(), ref.end()));
+    for (size_t i = 0; i < ref.size(); i += 7) {
+        EXPECT_EQ(lst[i], *std::next(ref.begin(), static_cast<long>(i)));
+    }
+
+    lst.reverse();
+    ref.reverse();
+    EXPECT_TRUE(std::equal(lst.begin(), lst.end(), ref.begin(), ref.end()));
+    EXPECT_TRUE(std::equal(
+        std::make_reverse_iterator(lst.end()),
+        std::make_reverse_iterator(lst.begin()), ref.rbegin(), ref.rend()));
+}
+
+TEST(UnrolledListTest, CopyMoveAndStrings) {
+    UnrolledList<std::string> a{"a", "b", "c", "d", "e"};
+    a.push_front(a.back());   // 引用自身元素
+    UnrolledList<std::string> b(a);
+    UnrolledList<std::string> c(std::move(a));
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(b.size(), 6);
+    EXPECT_EQ(c.front(), "e");
+    c.swap(a);
+    EXPECT_EQ(a.back(), "e");
+    a.clear();
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(a.begin(), a.end());
+}
+
+// MyQueue / MyStack 可以使用 UnrolledList 作为底层容器
+TEST(UnrolledListTest, QueueAndStackAdapters) {
+    MyQueue<int, UnrolledList<int>> q;
+    MyStack<int, UnrolledList<int>> st;
+    for (int i = 0; i < 100; ++i) {
+        q.push(i);
+        st.push(i);
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(q.front(), i);
+        EXPECT_EQ(st.top(), 99 - i);
+        q.pop();
+        st.pop();
+    }
+    EXPECT_TRUE(q.empty());
+    EXPECT_TRUE(st.empty());
+}
+
+// 测试 splice：被接走节点的链表销毁后，节点仍然有效
+TEST(MyListTest, SpliceOutlivesDonor) {
+    MyList<std::string> dst{"a", "z"};
+    {
+        MyList<std::string> src{"b", "c", "d", "e"};
+        auto                first = ++src.begin();
+        dst.splice(++dst.begin(), src, src.begin());   // b
+        EXPECT_EQ(src.size(), 3);
+        auto last = src.end();
+        --last;
+        dst.splice(--dst.end(), src, first, last);   // c d
+        EXPECT_EQ(src.size(), 1);
+        EXPECT_EQ(src.front(), "e");
+    }
+    std::string expected[] = {"a", "b", "c", "d", "z"};
+    ASSERT_EQ(dst.size(), 5);
+    EXPECT_TRUE(std::equal(dst.begin(), dst.end(), expected));
+
+    // 销毁后继续删除、插入来自其他内存池的节点
+    dst.erase(++dst.begin());
+    dst.push_back("y");
+    EXPECT_EQ(dst.size(), 5);
+
+    MyList<std::string> empty;
+    empty.splice(empty.end(), dst);
+    EXPECT_TRUE(dst.empty());
+    EXPECT_EQ(empty.size(), 5);
+    empty.clear();
+}
+
+// 借来的节点删光后放开对方的内存池；节点来回接过之后仍能正确归还
+TEST(MyListTest, SpliceReleasesDrainedPools) {
+    MyList<std::string> dst;
+    for (int round = 0; round < 50; ++round) {
+        MyList<std::string> src;
+        for (int i = 0; i < 40; ++i) {
+            src.push_back(std::string(30, static_cast<char>('a' + i % 26)));
+        }
+        dst.splice(dst.end(), src, src.begin(), std::next(src.begin(), 30));
+        // 一部分节点再接回去，在原来的链表里释放
+        src.splice(src.end(), dst, std::prev(dst.end(), 5), dst.end());
+        EXPECT_EQ(src.size(), 15);
+        src.merge(dst);
+        EXPECT_TRUE(dst.empty());
+        dst.swap(src);
+        while (dst.size() > 10) {
+            dst.pop_front();
+        }
+    }
+    ASSERT_EQ(dst.size(), 10);
+    for (const auto &s : dst) {
+        EXPECT_EQ(s.size(), 30);
+    }
+    dst.clear();
+    dst.push_back("x");
+    EXPECT_EQ(dst.front(), "x");
+}
+
+// 测试同一链表内的 splice 与原地 reverse
+TEST(MyListTest, SpliceWithinAndReverse) {
+    MyList<int> lst{1, 2, 3, 4, 5};
+    lst.splice(lst.end(), lst, lst.begin());   // 1 移到末尾
+    auto mid = std::next(lst.begin(), 2);
+    lst.splice(lst.begin(), lst, mid, lst.end());   // 4 5 1 移到开头
+    int expected[] = {4, 5, 1, 2, 3};
+    EXPECT_TRUE(std::equal(lst.begin(), lst.end(), expected));
+
+    int *addr = &lst.front();
+    lst.reverse();
+    EXPECT_EQ(&lst.back(), addr);   // 元素没有被移动
+    int reversed[] = {3, 2, 1, 5, 4};
+    EXPECT_TRUE(std::equal(lst.begin(), lst.end(), reversed));
+    EXPECT_EQ(*--lst.end(), 4);
+}
+
+// 测试 sort / merge 的稳定性，且只改链接不移动元素
+TEST(MyListTest, SortAndMerge) {
+    using Item = std::pair<int, int>;
+    auto by_key = [](const Item &a, const Item &b) {
+        return a.first < b.first;
+    };
+
+    MyList<Item> lst;
+    std::mt19937 rng(11);
+    for (int i = 0; i < 1000; ++i) {
+        lst.emplace_back(static_cast<int>(rng() % 50), i);
+    }
+    const Item *any = &*std::next(lst.begin(), 123);
+    Item        was = *any;
+    lst.sort(by_key);
+    EXPECT_EQ(*any, was);
+    EXPECT_EQ(lst.size(), 1000);
+    EXPECT_EQ(std::distance(lst.begin(), lst.end()), 1000);
+    EXPECT_TRUE(std::is_sorted(lst.begin(), lst.end(), by_key));
+    for (auto it = lst.begin(), nx = std::next(it); nx != lst.end();
+         ++it, ++nx) {
+        if (it->first == nx->first) {
+            EXPECT_LT(it->second, nx->second);
+        }
+    }
+
+    MyList<std::unique_ptr<int>> a, b;
+    for (int i = 0; i < 10; i += 2) a.push_back(std::make_unique<int>(i));
+    for (int i = 1; i < 10; i += 2) b.push_back(std::make_unique<int>(i));
+    using Ptr  = std::unique_ptr<int>;
+    auto deref = [](const Ptr &x, const Ptr &y) { return *x < *y; };
+    a.merge(b, deref);
+    EXPECT_TRUE(b.empty());
+    ASSERT_EQ(a.size(), 10);
+    int expected = 0;
+    for (const auto &p : a) {
+        EXPECT_EQ(*p, expected++);
+    }
+    EXPECT_EQ(expected, 10);
+
+    MyList<int> desc{5, 3, 9, 1};
+    desc.sort(std::greater<>());
+    int sorted[] = {9, 5, 3, 1};
+    EXPECT_TRUE(std::equal(desc.begin(), desc.end(), sorted, sorted + 4));
+}
+
+// 顺序插入后树高仍是对数级，随机增删与 std::map 对照
+TEST(MapTest, BalancedUnderSortedInsert) {
+    Map<int, int> m;
+    for (int i = 0; i < 100000; ++i) {
+        m.insert(i, i * 2);
+    }
+    EXPECT_LE(m.height(), 2 * 17u);
+    for (int i = 99999; i >= 0; i -= 2) {
+        m.erase(i);
+    }
+    EXPECT_LE(m.height(), 2 * 16u);
+    int expect = 0;
+    for (auto it = m.begin(); it != m.end(); ++it) {
+        EXPECT_EQ(it->first, expect);
+        EXPECT_EQ(it->second, expect * 2);
+        expect += 2;
+    }
+    EXPECT_EQ(expect, 100000);
+}
+
+TEST(MapTest, MatchesStdMap) {
+    Map<int, std::string>      m;
+    std::map<int, std::string> ref;
+    std::mt19937               rng(5);
+    for (int step = 0; step < 20000; ++step) {
+        int key = static_cast<int>(rng() % 2000);
+        if (rng() % 3) {
+            m.insert(key, std::to_string(step));
+            ref[key] = std::to_string(step);
+        } else {
+            m.erase(key);
+            ref.erase(key);
+        }
+    }
+    auto rit = ref.begin();
+    for (auto it = m.begin(); it != m.end(); ++it, ++rit) {
+        ASSERT_NE(rit, ref.end());
+        EXPECT_EQ(it->first, rit->first);
+        EXPECT_EQ(it->second, rit->second);
+    }
+    EXPECT_EQ(rit, ref.end());
+    for (int key = 0; key < 2000; ++key) {
+        EXPECT_EQ(m.find(key) != nullptr, ref.count(key) == 1);
+    }
+}
+
+// 删除其他元素不会让指向现有节点的指针失效
+TEST(MapTest, EraseKeepsOtherNodes) {
+    Map<int, int> m;
+    for (int i = 0; i < 64; ++i) {
+        m.insert(i, i);
+    }
+    TreeNode<int, int>* node = m.find(40);
+    for (int i = 0; i < 64; ++i) {
+        if (i != 40) {
+            m.erase(i);
+        }
+    }
+    EXPECT_EQ(m.find(40), node);
+    EXPECT_EQ(m.begin()->first, 40);
+}
+
+// 两种分配策略下 clear 后都能继续使用，非平凡析构的值会被正确释放
+TEST(MapTest, ArenaAndHeapNodes) {
+    Map<int, std::string, HeapNodes>  heap;
+    Map<int, std::string, ArenaNodes> arena;
+    Map<int, int>                     plain;
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            heap.insert(i, std::to_string(i));
+            arena.insert(i, std::to_string(i));
+            plain.insert(i, i);
+        }
+        for (int i = 0; i < 1000; i += 3) {
+            arena.erase(i);
+        }
+        EXPECT_EQ(heap.find(999)->data.second, "999");
+        EXPECT_EQ(arena.find(998)->data.second, "998");
+        EXPECT_EQ(arena.find(999), nullptr);
+        heap.clear();
+        arena.clear();
+        plain.clear();
+        EXPECT_EQ(heap.begin(), heap.end());
+        EXPECT_EQ(arena.begin(), arena.end());
+        EXPECT_EQ(plain.begin(), plain.end());
+    }
+}
+
+TEST(AVLMapTest, PutGetRemove) {
+    AVLMap<int, std::string>            arena;
+    AVLMap<int, std::string, HeapNodes> heap;
+    for (int i = 0; i < 2000; ++i) {
+        arena.put(i, std::to_string(i));
+        heap.put(i, std::to_string(i));
+    }
+    for (int i = 0; i < 2000; i += 2) {
+        arena.remove(i);
+        heap.remove(i);
+    }
+    EXPECT_EQ(arena.get(10), nullptr);
+    ASSERT_NE(arena.get(11), nullptr);
+    EXPECT_EQ(*arena.get(11), "11");
+    EXPECT_EQ(arena.inorder(), heap.inorder());
+    EXPECT_EQ(arena.inorder().size(), 1000u);
+    arena.clear();
+    EXPECT_TRUE(arena.inorder().empty());
+    arena.put(1, "one");
+    EXPECT_EQ(*arena.get(1), "one");
+}
+
+// 区间查询与 std::map 的 lower_bound / upper_bound 对照
+TEST(MapTest, RangeQueries) {
+    Map<int, int>      m;
+    AVLMap<int, int>   avl;
+    std::map<int, int> ref;
+    for (int i = 0; i < 500; ++i) {
+        int key = i * 3;
+        m.insert(key, i);
+        avl.put(key, i);
+        ref[key] = i;
+    }
+    for (int key = -2; key < 1505; ++key) {
+        auto lb = ref.lower_bound(key);
+        auto ub = ref.upper_bound(key);
+        EXPECT_EQ(m.lower_bound(key) == m.end(), lb == ref.end());
+        EXPECT_EQ(avl.lower_bound(key) == avl.end(), lb == ref.end());
+        if (lb != ref.end()) {
+            EXPECT_EQ(m.lower_bound(key)->first, lb->first);
+            EXPECT_EQ(avl.lower_bound(key)->key, lb->first);
+        }
+        if (ub != ref.end()) {
+            EXPECT_EQ(m.upper_bound(key)->first, ub->first);
+            EXPECT_EQ(avl.upper_bound(key)->key, ub->first);
+        }
+    }
+
+    auto [first, last] = avl.equal_range(30);
+    ASSERT_NE(first, last);
+    EXPECT_EQ(first->value, 10);
+    EXPECT_EQ(++first, last);
+
+    std::vector<int> keys, avlKeys;
+    for (auto& kv : m.range(100, 130)) {
+        keys.push_back(kv.first);
+    }
+    for (auto& node : avl.range(100, 130)) {
+        avlKeys.push_back(node.key);
+    }
+    std::vector<int> expect{102, 105, 108, 111, 114, 117, 120, 123, 126, 129};
+    EXPECT_EQ(keys, expect);
+    EXPECT_EQ(avlKeys, expect);
+    EXPECT_EQ(m.range(50, 50).begin(), m.end());
+    EXPECT_EQ(avl.range(2000, 3000).begin(), avl.end());
+
+    int count = 0;
+    for (auto it = avl.begin(); it != avl.end(); ++it) {
+        ++count;
+    }
+    EXPECT_EQ(count, 500);
+}
+
+// 批量建树：有序输入直接建成，乱序和重复的键先排序去重，后者保留最后一个值
+TEST(MapTest, BuildFromSortedRange) {
+    for (int n : {0, 1, 2, 3, 7, 8, 100, 1023, 1024}) {
+        std::vector<std::pair<int, int>> items;
+        for (int i = 0; i < n; ++i) {
+            items.emplace_back(i * 2, i);
+        }
+        Map<int, int>    m(items.begin(), items.end());
+        AVLMap<int, int> avl(items.begin(), items.end());
+        size_t           log2n = 0;
+        while ((size_t(2) << log2n) <= size_t(n)) ++log2n;
+        EXPECT_EQ(m.height(), n ? log2n + 1 : 0);
+        EXPECT_EQ(avl.inorder(), items);
+
+        // 每个缺子节点的位置到根的黑节点数相同，且没有相邻的红节点
+        int blacks = -1;
+        for (auto it = m.begin(); it != m.end(); ++it) {
+            TreeNode<int, int>* node = m.find(it->first);
+            if (node->left && node->right) continue;
+            int count = 0;
+            for (TreeNode<int, int>* p = node; p; p = p->parent) {
+                count += p->red ? 0 : 1;
+                EXPECT_FALSE(p->red && p->parent && p->parent->red);
+            }
+            if (blacks < 0) blacks = count;
+            EXPECT_EQ(count, blacks);
+        }
+
+        // 建好的树可以继续正常增删
+        for (int i = 0; i < n; i += 3) {
+            m.erase(i * 2);
+            avl.remove(i * 2);
+            m.insert(i * 2 + 1, i);
+            avl.put(i * 2 + 1, i);
+        }
+        std::map<int, int> ref(items.begin(), items.end());
+        for (int i = 0; i < n; i += 3) {
+            ref.erase(i * 2);
+            ref[i * 2 + 1] = i;
+        }
+        std::vector<std::pair<int, int>> expect(ref.begin(), ref.end());
+        std::vector<std::pair<int, int>> got;
+        for (auto it = m.begin(); it != m.end(); ++it) {
+            got.emplace_back(it->first, it->second);
+        }
+        EXPECT_EQ(got, expect);
+        EXPECT_EQ(avl.inorder(), expect);
+    }
+
+    std::vector<std::pair<int, std::string>> shuffled = {
+        {5, "a"}, {1, "b"}, {5, "c"}, {3, "d"}, {1, "e"}};
+    Map<int, std::string> m;
+    m.insert(100, "old");
+    m.assign_sorted(shuffled.begin(), shuffled.end());
+    EXPECT_EQ(m.find(100), nullptr);
+    EXPECT_EQ(m.find(1)->data.second, "e");
+    EXPECT_EQ(m.find(5)->data.second, "c");
+    AVLMap<int, std::string> avl(shuffled.begin(), shuffled.end());
+    std::vector<std::pair<int, std::string>> expect = {
+        {1, "e"}, {3, "d"}, {5, "c"}};
+    EXPECT_EQ(avl.inorder(), expect);
+}
+
+// 乱序输入排序去重时不能丢掉值：长字符串和 vector 都不在对象内部
+TEST(MapTest, BuildFromShuffledKeepsValues) {
+    std::vector<std::pair<int, std::string>>      words;
+    std::vector<std::pair<int, std::vector<int>>> lists;
+    for (int i = 0; i < 200; ++i) {
+        const size_t len = static_cast<size_t>(i % 5 + 1);
+        words.emplace_back(i, std::string(40, static_cast<char>('a' + i % 26)));
+        lists.emplace_back(i, std::vector<int>(len, i));
+    }
+    std::shuffle(words.begin(), words.end(), std::mt19937(18));
+    std::shuffle(lists.begin(), lists.end(), std::mt19937(18));
+
+    Map<int, std::string>         m(words.begin(), words.end());
+    AVLMap<int, std::string>      avl(words.begin(), words.end());
+    Map<int, std::vector<int>>    mlists(lists.begin(), lists.end());
+    AVLMap<int, std::vector<int>> avllists(lists.begin(), lists.end());
+    for (int i = 0; i < 200; ++i) {
+        std::string      word(40, static_cast<char>('a' + i % 26));
+        std::vector<int> list(static_cast<size_t>(i % 5 + 1), i);
+        EXPECT_EQ(m.find(i)->data.second, word);
+        EXPECT_EQ(*avl.get(i), word);
+        EXPECT_EQ(mlists.find(i)->data.second, list);
+        EXPECT_EQ(*avllists.get(i), list);
+    }
+}
+
+// 名次与第 k 小在随机增删后仍与有序数组一致
+TEST(AVLMapTest, RankAndSelect) {
+    AVLMap<int, int> avl;
+    std::set<int>    ref;
+    std::mt19937     rng(19);
+    for (int step = 0; step < 20000; ++step) {
+        int key = static_cast<int>(rng() % 3000);
+        if (rng() % 3) {
+            avl.put(key, key);
+            ref.insert(key);
+        } else {
+            avl.remove(key);
+            ref.erase(key);
+        }
+    }
+    std::vector<int> sorted(ref.begin(), ref.end());
+    ASSERT_EQ(avl.size(), sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        auto it = avl.select(i);
+        ASSERT_NE(it, avl.end());
+        EXPECT_EQ(it->key, sorted[i]);
+        EXPECT_EQ(avl.rank(sorted[i]), i);
+    }
+    EXPECT_EQ(avl.select(sorted.size()), avl.end());
+    for (int lo = -10; lo < 3010; lo += 37) {
+        int    hi     = lo + 250;
+        auto   first  = std::lower_bound(sorted.begin(), sorted.end(), lo);
+        auto   last   = std::lower_bound(sorted.begin(), sorted.end(), hi);
+        size_t expect = static_cast<size_t>(last - first);
+        EXPECT_EQ(avl.count_range(lo, hi), expect);
+        EXPECT_EQ(avl.count_range(hi, lo), 0u);
+    }
+    // select 得到的迭代器可以继续向后遍历
+    auto it = avl.select(sorted.size() / 2);
+    for (size_t i = sorted.size() / 2; i < sorted.size(); ++i, ++it) {
+        EXPECT_EQ(it->key, sorted[i]);
+    }
+    EXPECT_EQ(it, avl.end());
+
+    std::vector<std::pair<int, int>> items;
+    for (int i = 0; i < 100; ++i) items.emplace_back(i, i);
+    AVLMap<int, int> built(items.begin(), items.end());
+    EXPECT_EQ(built.size(), 100u);
+    EXPECT_EQ(built.select(42)->key, 42);
+    EXPECT_EQ(built.count_range(10, 20), 10u);
+
+    // 迭代器只能读节点，不能改动键和树的结构
+    static_assert(std::is_same_v<decltype(*built.begin()),
+                                 const AVLNode<int, int>&>);
+    static_assert(std::is_same_v<decltype(built.select(0).operator->()),
+                                 const AVLNode<int, int>*>);
+}
+
+// 集合运算的结果与 std::map 逐个计算的一致，规模足够大时会走并行路径
+TEST(AVLMapTest, SetOperations) {
+    std::mt19937 rng(23);
+    auto random_map = [&](size_t n, int range, std::map<int, int>& ref) {
+        ref.clear();
+        while (ref.size() < n) {
+            ref[static_cast<int>(rng() % static_cast<unsigned>(range))] =
+                static_cast<int>(rng());
+        }
+    };
+    auto to_vector = [](const std::map<int, int>& m) {
+        return std::vector<std::pair<int, int>>(m.begin(), m.end());
+    };
+
+    for (size_t m : {0u, 1u, 50u, 3000u, 40000u}) {
+        std::map<int, int> a, b;
+        random_map(40000, 100000, a);
+        random_map(m, 100000, b);
+        AVLMap<int, int> other(b.begin(), b.end());
+
+        AVLMap<int, int> avl(a.begin(), a.end());
+        avl_set::union_with(avl, other);
+        std::map<int, int> expect = a;
+        for (auto& kv : b) expect[kv.first] = kv.second;
+        EXPECT_EQ(avl.inorder(), to_vector(expect));
+        EXPECT_EQ(avl.size(), expect.size());
+
+        avl.assign_sorted(a.begin(), a.end());
+        avl_set::intersect_with(avl, other);
+        expect.clear();
+        for (auto& kv : a) {
+            if (b.count(kv.first)) expect.insert(kv);
+        }
+        EXPECT_EQ(avl.inorder(), to_vector(expect));
+        EXPECT_EQ(avl.size(), expect.size());
+
+        avl.assign_sorted(a.begin(), a.end());
+        avl_set::difference(avl, other);
+        expect.clear();
+        for (auto& kv : a) {
+            if (!b.count(kv.first)) expect.insert(kv);
+        }
+        EXPECT_EQ(avl.inorder(), to_vector(expect));
+        // 结果仍是合法的树，可以继续增删
+        for (size_t i = 0; i < expect.size(); i += 97) {
+            EXPECT_EQ(avl.rank(avl.select(i)->key), i);
+        }
+        avl.put(-1, 0);
+        avl.remove(-1);
+        EXPECT_EQ(avl.size(), expect.size());
+
+        // other 比本对象大时也一样
+        AVLMap<int, int> small(b.begin(), b.end());
+        AVLMap<int, int> large(a.begin(), a.end());
+        avl_set::union_with(small, large);
+        expect = b;
+        for (auto& kv : a) expect[kv.first] = kv.second;
+        EXPECT_EQ(small.inorder(), to_vector(expect));
+    }
+
+    AVLMap<int, int> avl;
+    for (int i = 0; i < 50000; ++i) avl.put(i, i);
+    avl_set::filter(avl, [](int key, int) { return key % 3 == 0; });
+    ASSERT_EQ(avl.size(), 16667u);
+    for (size_t i = 0; i < avl.size(); i += 101) {
+        EXPECT_EQ(avl.select(i)->key, static_cast<int>(i * 3));
+    }
+    avl_set::union_with(avl, avl);
+    EXPECT_EQ(avl.size(), 16667u);
+    avl_set::difference(avl, avl);
+    EXPECT_TRUE(avl.empty());
+}
+
+// 并集中途复制失败时，本对象保持原样，已复制的节点都被释放
+TEST(AVLMapTest, UnionIsStrongWhenCopyThrows) {
+    std::vector<std::pair<int, ThrowingCopy>> a, b;
+    for (int i = 0; i < 3000; ++i) {
+        a.emplace_back(2 * i, ThrowingCopy(i % 20));
+        b.emplace_back(3 * i, ThrowingCopy(i % 20 + 1));
+    }
+    AVLMap<int, ThrowingCopy> avl(a.begin(), a.end());
+    AVLMap<int, ThrowingCopy> other(b.begin(), b.end());
+    for (int budget : {0, 1000, 2999}) {
+        ThrowingCopy::budget = budget;
+        EXPECT_THROW(avl_set::union_with(avl, other), std::runtime_error);
+        ThrowingCopy::budget = -1;
+        ASSERT_EQ(avl.size(), 3000u);
+        auto it = avl.begin();
+        for (const auto& kv : a) {
+            EXPECT_EQ(it->key, kv.first);
+            EXPECT_EQ(it->value.text, kv.second.text);
+            ++it;
+        }
+    }
+    avl_set::union_with(avl, other);
+    EXPECT_EQ(avl.size(), 5000u);
+    EXPECT_EQ(avl.get(12)->text, std::string(40, 'f'));
+}
+
+// 两种布局在随机增删后都与 std::map 一致，删除后数组保持稠密
+template<bool SplitValues> void check_compact_avl_map() {
+    CompactAVLMap<int, std::string, SplitValues> avl;
+    std::map<int, std::string>                   ref;
+    std::mt19937                                 rng(24);
+    for (int step = 0; step < 50000; ++step) {
+        int key = static_cast<int>(rng() % 4000);
+        if (rng() % 2) {
+            std::string value = std::to_string(rng());
+            avl.put(key, value);
+            ref[key] = value;
+        } else {
+            avl.remove(key);
+            ref.erase(key);
+        }
+    }
+    ASSERT_EQ(avl.size(), ref.size());
+    std::vector<std::pair<int, std::string>> expect(ref.begin(), ref.end());
+    EXPECT_EQ(avl.inorder(), expect);
+    for (int key = -1; key <= 4000; ++key) {
+        auto it = ref.find(key);
+        if (it == ref.end()) {
+            EXPECT_EQ(avl.get(key), nullptr);
+        } else {
+            ASSERT_NE(avl.get(key), nullptr);
+            EXPECT_EQ(*avl.get(key), it->second);
+        }
+    }
+    for (auto& kv : ref) avl.remove(kv.first);
+    EXPECT_TRUE(avl.empty());
+    EXPECT_TRUE(avl.inorder().empty());
+}
+
+TEST(CompactAVLMapTest, MatchesStdMap) {
+    check_compact_avl_map<true>();
+    check_compact_avl_map<false>();
+    // 键和两个下标挤在 12 字节里，值放在一起时也只有 16 字节
+    EXPECT_EQ((CompactAVLMap<int, int>::node_bytes), 12u);
+    EXPECT_EQ((CompactAVLMap<int, int, false>::node_bytes), 16u);
+
+    CompactAVLMap<int, int> avl;
+    for (int i = 0; i < 1000; ++i) avl.put(i, i);
+    for (int i = 0; i < 1000; ++i) avl.put(i, -i);
+    EXPECT_EQ(avl.size(), 1000u);
+    EXPECT_EQ(*avl.get(999), -999);
+    avl.clear();
+    EXPECT_EQ(avl.get(1), nullptr);
+}
+
+// 随机增删后正向、反向遍历都与 std::map 一致，最小度数 2 时分裂合并最频繁
+TEST(BTreeTest, MatchesStdMap) {
+    for (size_t degree : {2u, 3u, 16u}) {
+        BTree<int, std::string>    tree(degree);
+        std::map<int, std::string> ref;
+        std::mt19937               rng(25);
+        for (int step = 0; step < 30000; ++step) {
+            int key = static_cast<int>(rng() % 2000);
+            if (rng() % 2) {
+                std::string value = std::to_string(rng());
+                EXPECT_EQ(tree.insert(key, value), ref.count(key) == 0);
+                ref[key] = value;
+            } else {
+                EXPECT_EQ(tree.erase(key), ref.erase(key) == 1);
+            }
+        }
+        ASSERT_EQ(tree.size(), ref.size());
+        auto it = tree.begin();
+        for (auto& kv : ref) {
+            ASSERT_NE(it, tree.end());
+            EXPECT_EQ(it.key(), kv.first);
+            EXPECT_EQ(it.value(), kv.second);
+            ++it;
+        }
+        EXPECT_EQ(it, tree.end());
+        for (auto r = ref.rbegin(); r != ref.rend(); ++r) {
+            --it;
+            EXPECT_EQ(it.key(), r->first);
+        }
+        EXPECT_EQ(it, tree.begin());
+        for (int key = -1; key <= 2000; ++key) {
+            std::string* value = tree.search(key);
+            auto         found = ref.find(key);
+            if (found == ref.end()) {
+                EXPECT_EQ(value, nullptr);
+                EXPECT_EQ(tree.find(key), tree.end());
+            } else {
+                ASSERT_NE(value, nullptr);
+                EXPECT_EQ(*value, found->second);
+            }
+        }
+        for (auto& kv : ref) EXPECT_TRUE(tree.erase(kv.first));
+        EXPECT_TRUE(tree.empty());
+        EXPECT_EQ(tree.begin(), tree.end());
+        EXPECT_FALSE(tree.erase(0));
+    }
+    EXPECT_THROW((BTree<int, int>(1)), std::runtime_error);
+}
+
+// 值类型没有默认构造函数时也能分裂、合并
+TEST(BTreeTest, NonDefaultConstructibleValues) {
+    BTree<int, Tracked> tree(2);
+    for (int i = 0; i < 200; ++i) tree.insert(i, Tracked(i * 2));
+    for (int i = 0; i < 200; i += 3) EXPECT_TRUE(tree.erase(i));
+    int expect = 1;
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        if (expect % 3 == 0) ++expect;
+        EXPECT_EQ(it.key(), expect);
+        EXPECT_EQ(it.value().value, expect * 2);
+        ++expect;
+    }
+    EXPECT_EQ(tree.size(), 133u);
+}
+
+// 区间查询跨越多个叶子，边界与 lower_bound / upper_bound 一致
+TEST(BTreeTest, RangeAndBounds) {
+    BTree<int, int> tree(3);
+    for (int i = 0; i < 1000; i += 2) tree.insert(i, i * 10);
+
+    std::vector<int> keys;
+    for (auto kv : tree.range(101, 301)) {
+        keys.push_back(kv.first);
+        EXPECT_EQ(kv.second, kv.first * 10);
+    }
+    std::vector<int> expect;
+    for (int i = 102; i < 301; i += 2) expect.push_back(i);
+    EXPECT_EQ(keys, expect);
+
+    EXPECT_EQ(tree.lower_bound(101).key(), 102);
+    EXPECT_EQ(tree.lower_bound(102).key(), 102);
+    EXPECT_EQ(tree.upper_bound(102).key(), 104);
+    EXPECT_EQ(tree.lower_bound(999), tree.end());
+    EXPECT_EQ(tree.upper_bound(998), tree.end());
+    EXPECT_EQ(tree.lower_bound(-5), tree.begin());
+    EXPECT_EQ(tree.range(300, 100).begin(), tree.end());
+    EXPECT_EQ((--tree.end()).key(), 998);
+
+    tree.find(500).value() = -1;
+    EXPECT_EQ(*tree.search(500), -1);
+}
+
+// 嵌套的 fork_join 不会卡死，任务中的异常传回调用方
+TEST(ThreadPoolTest, NestedForkJoin) {
+    ThreadPool pool(3);
+    std::function<long(long, long)> sum = [&](long lo, long hi) -> long {
+        if (hi - lo <= 64) {
+            long s = 0;
+            for (long i = lo; i < hi; ++i) s += i;
+            return s;
+        }
+        long mid = lo + (hi - lo) / 2, left = 0, right = 0;
+        pool.fork_join([&] { left = sum(lo, mid); },
+                       [&] { right = sum(mid, hi); });
+        return left + right;
+    };
+    EXPECT_EQ(sum(0, 100000), 100000L * 99999 / 2);
+
+    EXPECT_THROW(pool.fork_join([] {},
+                                [] { throw std::runtime_error("second"); }),
+                 std::runtime_error);
+    EXPECT_THROW(pool.fork_join([] { throw std::runtime_error("first"); },
+                                [] {}),
+                 std::runtime_error);
+}
+
+TEST(ConcurrentAVLMapTest, MatchesStdMap) {
+    ConcurrentAVLMap<int, std::string> m;
+    std::map<int, std::string>         ref;
+    std::mt19937                       rng(21);
+    for (int step = 0; step < 30000; ++step) {
+        int key = static_cast<int>(rng() % 2000);
+        if (rng() % 3) {
+            m.put(key, std::to_string(step));
+            ref[key] = std::to_string(step);
+        } else {
+            EXPECT_EQ(m.remove(key), ref.erase(key) == 1);
+        }
+    }
+    for (int key = 0; key < 2000; ++key) {
+        std::string value;
+        auto        it = ref.find(key);
+        ASSERT_EQ(m.get(key, value), it != ref.end());
+        if (it != ref.end()) {
+            EXPECT_EQ(value, it->second);
+        }
+    }
+    std::vector<std::pair<int, std::string>> expect(
+        ref.lower_bound(100), ref.lower_bound(1500));
+    EXPECT_EQ(m.range(100, 1500), expect);
+    EXPECT_TRUE(m.range(1500, 100).empty());
+    for (int key = 0; key < 2000; ++key) {
+        m.remove(key);
+    }
+    EXPECT_TRUE(m.empty());
+}
+
+// 每个受检的键只由一个写线程修改：第 s 步 s 为奇数时写入 s，偶数时删除，
+// 操作前后分别公布 started 和 done。读到的结果必须对应 [done, started]
+// 之间某一步之后的状态，否则不可线性化。另有一组从不修改的键，
+// 范围查询必须完整取到；奇数键由所有写线程随机增删，制造旋转和摘除
+TEST(ConcurrentAVLMapTest, LinearizableUnderStress) {
+    const int writers = 3, readers = 3, steps = 20000;
+    const int owned = 64, stable = 256;
+    ConcurrentAVLMap<int, int> m;
+    std::vector<std::atomic<int>> started(owned), done(owned);
+    for (int i = 0; i < owned; ++i) {
+        started[static_cast<size_t>(i)].store(0);
+        done[static_cast<size_t>(i)].store(0);
+    }
+    // 稳定键 4i，受检键 4i + 2，随机键为奇数
+    for (int i = 0; i < stable; ++i) {
+        m.put(4 * i, i);
+    }
+    std::atomic<bool>        finished(false);
+    std::atomic<bool>        ok(true);
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            std::mt19937 rng(static_cast<unsigned>(w));
+            for (int s = 1; s <= steps; ++s) {
+                for (int i = w; i < owned; i += writers) {
+                    if (rng() % 8 != 0) continue;
+                    auto idx  = static_cast<size_t>(i);
+                    int  step = done[idx].load() + 1;
+                    started[idx].store(step);
+                    if (step % 2) {
+                        m.put(4 * i + 2, step);
+                    } else {
+                        m.remove(4 * i + 2);
+                    }
+                    done[idx].store(step);
+                }
+                int key = static_cast<int>(rng() % (8 * stable)) | 1;
+                if (rng() % 2) {
+                    m.put(key, key);
+                } else {
+                    m.remove(key);
+                }
+            }
+        });
+    }
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            std::mt19937 rng(static_cast<unsigned>(100 + r));
+            while (!finished.load()) {
+                int  i     = static_cast<int>(rng() % owned);
+                auto idx   = static_cast<size_t>(i);
+                int  lower = done[idx].load();
+                int  value = 0;
+                bool found = m.get(4 * i + 2, value);
+                int  upper = started[idx].load();
+                if (found) {
+                    ok = ok && value % 2 == 1 && lower <= value
+                      && value <= upper;
+                } else {
+                    ok = ok && (lower % 2 == 0 || upper > lower);
+                }
+
+                int  lo    = static_cast<int>(rng() % (4 * stable));
+                auto items = m.range(lo, lo + 64);
+                int  seen  = 0;
+                for (size_t j = 0; j < items.size(); ++j) {
+                    int key = items[j].first;
+                    ok = ok && key >= lo && key < lo + 64;
+                    ok = ok && (j == 0 || items[j - 1].first < key);
+                    if (key % 4 == 0) {
+                        ok = ok && items[j].second == key / 4;
+                        ++seen;
+                    }
+                }
+                int expect = 0;
+                for (int key = lo; key < lo + 64; ++key) {
+                    expect += key % 4 == 0 && key < 4 * stable;
+                }
+                ok = ok && seen == expect;
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (int w = 0; w < writers; ++w) {
+        threads[static_cast<size_t>(w)].join();
+    }
+    finished = true;
+    for (size_t t = static_cast<size_t>(writers); t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    EXPECT_TRUE(ok.load());
+    for (int i = 0; i < owned; ++i) {
+        int  last  = done[static_cast<size_t>(i)].load();
+        int  value = 0;
+        bool found = m.get(4 * i + 2, value);
+        EXPECT_EQ(found, last % 2 == 1);
+        if (found) {
+            EXPECT_EQ(value, last);
+        }
+    }
+    for (int i = 0; i < stable; ++i) {
+        int value = -1;
+        EXPECT_TRUE(m.get(4 * i, value));
+        EXPECT_EQ(value, i);
+    }
+}
+
+// 每个快照都保持取快照时的内容，修改当前版本不影响它们
+TEST(PersistentAVLMapTest, SnapshotsAreIsolated) {
+    PersistentAVLMap<int, std::string>              m;
+    std::map<int, std::string>                      ref;
+    std::vector<PersistentAVLMap<int, std::string>> snaps;
+    std::vector<std::map<int, std::string>>         expect;
+    std::mt19937                                    rng(22);
+    for (int step = 0; step < 20000; ++step) {
+        int key = static_cast<int>(rng() % 1000);
+        if (rng() % 3) {
+            m.put(key, std::to_string(step));
+            ref[key] = std::to_string(step);
+        } else {
+            m.remove(key);
+            ref.erase(key);
+        }
+        if (step % 2000 == 0) {
+            snaps.push_back(m.snapshot());
+            expect.push_back(ref);
+        }
+    }
+    EXPECT_EQ(m.size(), ref.size());
+    std::vector<std::pair<int, std::string>> all(ref.begin(), ref.end());
+    EXPECT_EQ(m.inorder(), all);
+    for (size_t i = 0; i < snaps.size(); ++i) {
+        std::vector<std::pair<int, std::string>> items(
+            expect[i].begin(), expect[i].end());
+        EXPECT_EQ(snaps[i].inorder(), items);
+        EXPECT_EQ(snaps[i].size(), expect[i].size());
+    }
+    // 丢掉中间的快照后其余版本不受影响
+    snaps.erase(snaps.begin() + 1, snaps.end() - 1);
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    std::vector<std::pair<int, std::string>> last(
+        expect.back().begin(), expect.back().end());
+    EXPECT_EQ(snaps.back().inorder(), last);
+    EXPECT_NE(snaps.front().get(expect[0].begin()->first), nullptr);
+}
+
+// 写线程每轮把所有键改成轮次号后发布快照，读线程拿到快照后无锁读取，
+// 看到的必须是某一轮完整的结果
+TEST(PersistentAVLMapTest, SnapshotsReadableFromOtherThreads) {
+    const int                  keys = 500, rounds = 200, readers = 3;
+    PersistentAVLMap<int, int> m;
+    PersistentAVLMap<int, int> published;
+    std::mutex                 mutex;
+    std::atomic<bool>          finished(false);
+    std::atomic<bool>          ok(true);
+    std::vector<std::thread>   threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            while (!finished.load()) {
+                PersistentAVLMap<int, int> snap;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    snap = published;
+                }
+                if (snap.empty()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                int    round = snap.begin()->value;
+                size_t count = 0;
+                for (auto it = snap.begin(); it != snap.end(); ++it) {
+                    ok = ok && it->value == round;
+                    ++count;
+                }
+                ok = ok && count == static_cast<size_t>(keys);
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (int round = 0; round < rounds; ++round) {
+        for (int k = 0; k < keys; ++k) {
+            m.put(k, round);
+        }
+        PersistentAVLMap<int, int>  snap = m.snapshot();
+        std::lock_guard<std::mutex> lock(mutex);
+        published = std::move(snap);
+    }
+    finished = true;
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_TRUE(ok.load());
+    EXPECT_EQ(*published.get(keys - 1), rounds - 1);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();